@@ -0,0 +1,144 @@
+/*
+ * Batch queue benchmark.
+ *
+ * A producer thread pushes ITEMS items through a queue of QUEUE_DEPTH to
+ * a consumer thread, first through a k_msgq one item per call, then
+ * through a batchq with the batch sizes in batches[]. Both threads run at
+ * the same priority and block when the queue is full or empty. The time
+ * from the first put to the last get gives the items/s; the batchq
+ * counters give the number of times a thread blocked and the number of
+ * wakeups per 1000 items.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#include "batchq.h"
+
+#define STACKSIZE 1024
+#define PRIORITY 7
+
+#define ITEMS 20000
+#define QUEUE_DEPTH 64
+#define MAX_BATCH 64
+
+struct data_item_type {
+	uint32_t field1;
+	uint32_t field2;
+	uint32_t field3;
+};
+
+K_MSGQ_DEFINE(single_q, sizeof(struct data_item_type), QUEUE_DEPTH, 4);
+BATCHQ_DEFINE(batch_q, sizeof(struct data_item_type), QUEUE_DEPTH);
+
+static const size_t batches[] = { 1, 4, 16, 64 };
+
+K_THREAD_STACK_DEFINE(producer_stack, STACKSIZE);
+K_THREAD_STACK_DEFINE(consumer_stack, STACKSIZE);
+static struct k_thread producer_thread;
+static struct k_thread consumer_thread;
+
+static uint32_t start_cycles;
+static uint32_t end_cycles;
+static uint32_t errors;
+
+static void single_producer(void *p1, void *p2, void *p3)
+{
+	struct data_item_type data = { 0 };
+
+	start_cycles = k_cycle_get_32();
+	for (uint32_t i = 0; i < ITEMS; i++) {
+		data.field1 = i;
+		k_msgq_put(&single_q, &data, K_FOREVER);
+	}
+}
+
+static void single_consumer(void *p1, void *p2, void *p3)
+{
+	struct data_item_type data;
+
+	for (uint32_t i = 0; i < ITEMS; i++) {
+		k_msgq_get(&single_q, &data, K_FOREVER);
+		errors += data.field1 != i;
+	}
+	end_cycles = k_cycle_get_32();
+}
+
+static void batch_producer(void *p1, void *p2, void *p3)
+{
+	size_t batch = (size_t)p1;
+	struct data_item_type data[MAX_BATCH];
+	uint32_t seq = 0;
+	size_t n;
+
+	start_cycles = k_cycle_get_32();
+	while (seq < ITEMS) {
+		n = MIN(batch, ITEMS - seq);
+		for (size_t i = 0; i < n; i++) {
+			data[i].field1 = seq++;
+		}
+		batchq_put(&batch_q, data, n, K_FOREVER);
+	}
+}
+
+static void batch_consumer(void *p1, void *p2, void *p3)
+{
+	size_t batch = (size_t)p1;
+	struct data_item_type data[MAX_BATCH];
+	uint32_t seq = 0;
+	size_t n;
+
+	while (seq < ITEMS) {
+		n = batchq_get(&batch_q, data, batch, K_FOREVER);
+		for (size_t i = 0; i < n; i++) {
+			errors += data[i].field1 != seq++;
+		}
+	}
+	end_cycles = k_cycle_get_32();
+}
+
+/* run one producer/consumer pair to the end, return items/s */
+static uint32_t run(k_thread_entry_t producer, k_thread_entry_t consumer,
+		    size_t batch)
+{
+	uint32_t us;
+
+	k_thread_create(&consumer_thread, consumer_stack,
+			K_THREAD_STACK_SIZEOF(consumer_stack), consumer,
+			(void *)batch, NULL, NULL, PRIORITY, 0, K_NO_WAIT);
+	k_thread_create(&producer_thread, producer_stack,
+			K_THREAD_STACK_SIZEOF(producer_stack), producer,
+			(void *)batch, NULL, NULL, PRIORITY, 0, K_NO_WAIT);
+
+	k_thread_join(&producer_thread, K_FOREVER);
+	k_thread_join(&consumer_thread, K_FOREVER);
+
+	us = MAX(k_cyc_to_us_floor32(end_cycles - start_cycles), 1);
+	return (uint32_t)((uint64_t)ITEMS * USEC_PER_SEC / us);
+}
+
+void main(void)
+{
+	struct batchq_stats s;
+	uint32_t rate;
+
+	printk("%u items, queue depth %u\n", ITEMS, QUEUE_DEPTH);
+	printk("%-14s %10s %14s %14s\n", "", "items/s",
+	       "waits/1000", "wakeups/1000");
+
+	rate = run(single_producer, single_consumer, 1);
+	printk("%-14s %10u %14s %14s\n", "k_msgq", rate, "-", "-");
+
+	for (size_t b = 0; b < ARRAY_SIZE(batches); b++) {
+		batchq_stats_take(&batch_q, &s);
+		rate = run(batch_producer, batch_consumer, batches[b]);
+		batchq_stats_take(&batch_q, &s);
+
+		printk("batchq x%-6u %10u %14u %14u\n", (uint32_t)batches[b],
+		       rate, s.waits * 1000 / ITEMS, s.wakeups * 1000 / ITEMS);
+	}
+
+	if (errors) {
+		printk("%u items out of order\n", errors);
+	}
+}
@@ -0,0 +1,294 @@
+/*
+ * Button debounce stress harness for native_sim.
+ *
+ * The button poll loop of loading_leds_and_button.c (periodic sampling +
+ * lib/debounce) runs against the gpio_emul driver. Each accepted press
+ * toggles led0, like the original toggle(). The harness drives the emulated
+ * button with scripted and random edge trains, samples led0 every SAMPLE_US
+ * from a timer and checks that every press toggled the LED exactly once,
+ * within RESPONSE_LIMIT_US of the contact settling.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/sys/printk.h>
+
+#if defined(CONFIG_ARCH_POSIX)
+#include <posix_board_if.h>
+#endif
+
+#include "debounce.h"
+#include "periodic.h"
+
+#define DEBOUNCE_TIME_MS 10
+#define POLL_TIME_MS	DEBOUNCE_TIME_MS
+
+/* scheduling priority of the poll loop, the harness runs above it */
+#define STACKSIZE 1024
+#define PRIORITY 7
+
+/* LED recorder resolution */
+#define SAMPLE_US 100
+
+/*
+ * Worst case: the contact settles just after a sample, the edge is seen on
+ * the next one and confirmed one period later. Plus one recorder sample.
+ */
+#define RESPONSE_LIMIT_US (2 * POLL_TIME_MS * 1000 + SAMPLE_US)
+
+/* bounce bursts stay below one poll period, the debounce limit */
+#define BOUNCE_MAX_EDGES 3
+#define BOUNCE_MAX_SPACING_US 1200
+
+#define MAX_PRESSES 256
+#define MAX_TRANSITIONS 512
+
+#define RANDOM_PRESSES 200
+#define RANDOM_SEED 0x2545f491
+
+static const struct gpio_dt_spec button = GPIO_DT_SPEC_GET(DT_ALIAS(sw0), gpios);
+static const struct gpio_dt_spec led0 = GPIO_DT_SPEC_GET(DT_ALIAS(led0), gpios);
+
+/* app under test, same poll loop as loading_leds_and_button.c */
+
+static PERIODIC_TASK_DEFINE(button_poll, POLL_TIME_MS, 0, 0);
+
+K_THREAD_STACK_DEFINE(poll_stack_area, STACKSIZE);
+static struct k_thread poll_data;
+
+bool is_pressed()
+{
+	return gpio_pin_get_dt(&button) == 0;
+}
+
+void poll_thread(void *dummy1, void *dummy2, void *dummy3)
+{
+	struct debounce button_debounce = {0};
+
+	periodic_task_start(&button_poll);
+
+	while (1) {
+		if (debounce_sample(&button_debounce, is_pressed())) {
+			gpio_pin_toggle_dt(&led0);
+		}
+		periodic_task_wait(&button_poll);
+	}
+}
+
+/* harness */
+
+static int64_t settled[MAX_PRESSES];  /* when each press stopped bouncing */
+static int presses;
+
+static int64_t transitions[MAX_TRANSITIONS];
+static int n_transitions;
+static int led_level;
+
+static uint32_t rand_state = RANDOM_SEED;
+
+static uint32_t rand_range(uint32_t min, uint32_t max)
+{
+	/* xorshift32, so every run sees the same edge trains */
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 17;
+	rand_state ^= rand_state << 5;
+
+	return min + rand_state % (max - min + 1);
+}
+
+static void record_led(struct k_timer *timer)
+{
+	int level = gpio_emul_output_get(led0.port, led0.pin);
+
+	if (level != led_level && n_transitions < MAX_TRANSITIONS) {
+		transitions[n_transitions++] = k_uptime_ticks();
+	}
+	led_level = level;
+}
+
+K_TIMER_DEFINE(led_recorder, record_led, NULL);
+
+static void button_set(bool pressed)
+{
+	/* is_pressed() reads a low level as pressed */
+	gpio_emul_input_set(button.port, button.pin, pressed ? 0 : 1);
+}
+
+/* toggle `edges` times around the final level, then settle on it */
+static void bounce(bool final, int edges, uint32_t spacing_us)
+{
+	for (int i = 0; i < edges; i++) {
+		button_set(final);
+		k_usleep(spacing_us);
+		button_set(!final);
+		k_usleep(spacing_us);
+	}
+	button_set(final);
+}
+
+static void press(uint32_t hold_us, int press_edges, int release_edges,
+		  uint32_t spacing_us)
+{
+	bounce(true, press_edges, spacing_us);
+	if (presses < MAX_PRESSES) {
+		settled[presses++] = k_uptime_ticks();
+	}
+	k_usleep(hold_us);
+	bounce(false, release_edges, spacing_us);
+}
+
+static void clean_presses(void)
+{
+	for (int i = 0; i < 5; i++) {
+		press(3 * POLL_TIME_MS * 1000, 0, 0, 0);
+		k_usleep(3 * POLL_TIME_MS * 1000);
+	}
+}
+
+static void press_bounce(void)
+{
+	for (int i = 0; i < 5; i++) {
+		press(3 * POLL_TIME_MS * 1000, BOUNCE_MAX_EDGES, 0, 1000);
+		k_usleep(3 * POLL_TIME_MS * 1000);
+	}
+}
+
+static void release_bounce(void)
+{
+	for (int i = 0; i < 5; i++) {
+		press(3 * POLL_TIME_MS * 1000, 0, BOUNCE_MAX_EDGES, 1000);
+		k_usleep(3 * POLL_TIME_MS * 1000);
+	}
+}
+
+/* pulses shorter than a poll period must never count as a press */
+static void short_glitches(void)
+{
+	for (int i = 0; i < 20; i++) {
+		button_set(true);
+		k_usleep(2000);
+		button_set(false);
+		k_usleep(25 * 1000);
+	}
+}
+
+/* fastest rate the debounce guarantees: 2.5 periods down, 2.5 up */
+static void rapid_presses(void)
+{
+	for (int i = 0; i < 50; i++) {
+		press(25 * POLL_TIME_MS * 100, 0, 0, 0);
+		k_usleep(25 * POLL_TIME_MS * 100);
+	}
+}
+
+static void random_presses(void)
+{
+	for (int i = 0; i < RANDOM_PRESSES; i++) {
+		press(rand_range((2 * POLL_TIME_MS + 2) * 1000, 6 * POLL_TIME_MS * 1000),
+		      rand_range(0, BOUNCE_MAX_EDGES), rand_range(0, BOUNCE_MAX_EDGES),
+		      rand_range(100, BOUNCE_MAX_SPACING_US));
+		k_usleep(rand_range(2 * POLL_TIME_MS * 1000, 6 * POLL_TIME_MS * 1000));
+	}
+}
+
+struct scenario {
+	const char *name;
+	void (*run)(void);
+};
+
+static const struct scenario scenarios[] = {
+	{ "clean presses", clean_presses },
+	{ "press bounce", press_bounce },
+	{ "release bounce", release_bounce },
+	{ "short glitches", short_glitches },
+	{ "rapid presses", rapid_presses },
+	{ "random presses", random_presses },
+};
+
+/*
+ * Every LED transition between two settle times belongs to the earlier
+ * press: none is a missed press, more than one is a false press.
+ */
+static bool check(const struct scenario *s)
+{
+	int missed = 0, extra = 0, t = 0;
+	uint32_t response = 0, worst = 0;
+
+	/* anything before the first press is a false press */
+	while (t < n_transitions && (presses == 0 || transitions[t] < settled[0])) {
+		extra++;
+		t++;
+	}
+
+	for (int p = 0; p < presses; p++) {
+		int64_t next = p + 1 < presses ? settled[p + 1] : INT64_MAX;
+		int seen = 0;
+
+		while (t < n_transitions && transitions[t] < next) {
+			if (seen++ == 0) {
+				response = k_ticks_to_us_floor32(transitions[t] - settled[p]);
+				if (response > worst) {
+					worst = response;
+				}
+			}
+			t++;
+		}
+		if (seen == 0) {
+			missed++;
+		} else {
+			extra += seen - 1;
+		}
+	}
+
+	bool pass = missed == 0 && extra == 0 && worst <= RESPONSE_LIMIT_US &&
+		    n_transitions < MAX_TRANSITIONS;
+
+	printk("%s %-15s presses %3d, missed %d, false %d, worst response %u us\n",
+	       pass ? "PASS" : "FAIL", s->name, presses, missed, extra, worst);
+
+	return pass;
+}
+
+void main(void)
+{
+	int failures = 0;
+
+	gpio_pin_configure_dt(&button, GPIO_INPUT);
+	gpio_pin_configure_dt(&led0, GPIO_OUTPUT_LOW);
+	button_set(false);
+
+	k_thread_create(&poll_data, poll_stack_area,
+			K_THREAD_STACK_SIZEOF(poll_stack_area),
+			poll_thread, NULL, NULL, NULL,
+			PRIORITY, 0, K_FOREVER);
+	k_thread_name_set(&poll_data, "button_poll");
+	k_thread_start(&poll_data);
+
+	led_level = gpio_emul_output_get(led0.port, led0.pin);
+	k_timer_start(&led_recorder, K_USEC(SAMPLE_US), K_USEC(SAMPLE_US));
+
+	printk("debounce %d ms, response limit %d us, seed 0x%08x\n",
+	       DEBOUNCE_TIME_MS, RESPONSE_LIMIT_US, RANDOM_SEED);
+
+	for (int i = 0; i < ARRAY_SIZE(scenarios); i++) {
+		presses = 0;
+		n_transitions = 0;
+
+		scenarios[i].run();
+		/* let the last press be confirmed */
+		k_msleep(4 * POLL_TIME_MS);
+
+		if (!check(&scenarios[i])) {
+			failures++;
+		}
+	}
+
+	k_timer_stop(&led_recorder);
+	periodic_task_report(&button_poll);
+	printk("%d of %d scenarios failed\n", failures, (int)ARRAY_SIZE(scenarios));
+
+#if defined(CONFIG_ARCH_POSIX)
+	posix_exit(failures ? 1 : 0);
+#endif
+}
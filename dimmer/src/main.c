@@ -0,0 +1,87 @@
+/*
+ * Software PWM on the four board LEDs.
+ *
+ * First every LED fades up and down, in alternation, for SWEEP_MS at each of
+ * the frequencies in freqs[], and the handler cost is reported for each.
+ * Then the chase of loading_leds.c runs with fades instead of toggles: the
+ * current LED fades in while the previous one fades out.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/printk.h>
+
+#include "softpwm.h"
+
+#define LED0_NODE DT_ALIAS(led0)
+#define LED1_NODE DT_ALIAS(led1)
+#define LED2_NODE DT_ALIAS(led2)
+#define LED3_NODE DT_ALIAS(led3)
+
+#define SWEEP_MS	3000
+#define BREATHE_MS	500
+#define CHASE_MS	250
+
+static const struct gpio_dt_spec led0 = GPIO_DT_SPEC_GET(LED0_NODE, gpios);
+static const struct gpio_dt_spec led1 = GPIO_DT_SPEC_GET(LED1_NODE, gpios);
+static const struct gpio_dt_spec led2 = GPIO_DT_SPEC_GET(LED2_NODE, gpios);
+static const struct gpio_dt_spec led3 = GPIO_DT_SPEC_GET(LED3_NODE, gpios);
+
+static const struct gpio_dt_spec *const leds[] = { &led0, &led1, &led2, &led3 };
+
+static const uint32_t freqs[] = { 100, 200, 500, 1000 };
+
+static struct softpwm pwm;
+
+/* fade every LED up and down, odd ones dark while even ones are lit */
+static void breathe(uint32_t ms)
+{
+	int64_t end = k_uptime_get() + ms;
+	uint8_t target[ARRAY_SIZE(leds)];
+
+	for (size_t i = 0; i < ARRAY_SIZE(leds); i++) {
+		target[i] = i % 2 ? 255 : 0;
+		softpwm_set(&pwm, i, target[i]);
+	}
+
+	while (k_uptime_get() < end) {
+		for (size_t i = 0; i < ARRAY_SIZE(leds); i++) {
+			if (!softpwm_fading(&pwm, i)) {
+				target[i] = 255 - target[i];
+				softpwm_fade(&pwm, i, target[i], BREATHE_MS);
+			}
+		}
+		k_msleep(BREATHE_MS / 4);
+	}
+}
+
+void main(void)
+{
+	size_t cur = 0;
+	int ret;
+
+	ret = softpwm_init(&pwm, leds, ARRAY_SIZE(leds));
+	if (ret < 0) {
+		printk("softpwm_init failed: %d\n", ret);
+		return;
+	}
+
+	for (size_t f = 0; f < ARRAY_SIZE(freqs); f++) {
+		softpwm_start(&pwm, freqs[f]);
+		breathe(SWEEP_MS);
+		softpwm_report(&pwm);
+		softpwm_stop(&pwm);
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(leds); i++) {
+		softpwm_set(&pwm, i, 0);
+	}
+	softpwm_start(&pwm, 200);
+
+	while (1) {
+		softpwm_fade(&pwm, cur, 0, 2 * CHASE_MS);
+		cur = (cur + 1) % ARRAY_SIZE(leds);
+		softpwm_fade(&pwm, cur, 255, CHASE_MS);
+		k_msleep(CHASE_MS);
+	}
+}
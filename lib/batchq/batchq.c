@@ -0,0 +1,168 @@
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include "batchq.h"
+
+/* copy n items into the ring at q->head; the caller holds the lock */
+static void copy_in(struct batchq *q, const uint8_t *items, uint32_t n)
+{
+	uint32_t first = MIN(n, q->max_items - q->head);
+
+	memcpy(q->buf + q->head * q->item_size, items, first * q->item_size);
+	memcpy(q->buf, items + first * q->item_size, (n - first) * q->item_size);
+
+	q->head = (q->head + n) % q->max_items;
+	q->used += n;
+}
+
+/* copy the n oldest items out of the ring; the caller holds the lock */
+static void copy_out(struct batchq *q, uint8_t *items, uint32_t n)
+{
+	uint32_t tail = (q->head + q->max_items - q->used) % q->max_items;
+	uint32_t first = MIN(n, q->max_items - tail);
+
+	memcpy(items, q->buf + tail * q->item_size, first * q->item_size);
+	memcpy(items + first * q->item_size, q->buf, (n - first) * q->item_size);
+
+	q->used -= n;
+}
+
+/*
+ * Drop the lock and block on `sem` until woken or `end`, then take the
+ * lock again. The waiter count is raised under the lock, after the caller
+ * found no room or no items, so a thread that changes the queue after
+ * that sees it and gives the semaphore.
+ *
+ * `wake`, if not NULL, is given once the lock is dropped and before
+ * blocking: the caller's work so far may be what the other side waits for.
+ */
+static int wait(struct batchq *q, k_spinlock_key_t *key, struct k_sem *sem,
+		uint32_t *waiters, struct k_sem *wake, k_timepoint_t end)
+{
+	int ret;
+
+	(*waiters)++;
+	q->stats.waits++;
+	q->stats.wakeups += wake != NULL;
+	k_spin_unlock(&q->lock, *key);
+
+	if (wake != NULL) {
+		k_sem_give(wake);
+	}
+
+	ret = k_sem_take(sem, sys_timepoint_timeout(end));
+
+	*key = k_spin_lock(&q->lock);
+	(*waiters)--;
+
+	return ret;
+}
+
+size_t batchq_put(struct batchq *q, const void *items, size_t n,
+		  k_timeout_t timeout)
+{
+	k_timepoint_t end = sys_timepoint_calc(timeout);
+	const uint8_t *src = items;
+	size_t done = 0;
+	k_spinlock_key_t key;
+	uint32_t k, unannounced = 0;
+	bool wake_getter, wake_putter;
+
+	key = k_spin_lock(&q->lock);
+	while (1) {
+		k = MIN(n - done, q->max_items - q->used);
+		copy_in(q, src + done * q->item_size, k);
+		done += k;
+		unannounced += k;
+
+		if (done == n || K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+			break;
+		}
+
+		/*
+		 * Anything left over means the queue is full. A consumer may be
+		 * asleep on the items just copied in: wake it before blocking,
+		 * or neither side ever runs again.
+		 */
+		wake_getter = unannounced > 0 && q->get_waiters > 0;
+		if (wake_getter) {
+			unannounced = 0;
+		}
+		if (wait(q, &key, &q->not_full, &q->put_waiters,
+			 wake_getter ? &q->not_empty : NULL, end) != 0) {
+			break;
+		}
+	}
+
+	/* one wakeup for everything queued since the last one */
+	wake_getter = unannounced > 0 && q->get_waiters > 0;
+	/* pass on a wakeup we may have taken from another producer */
+	wake_putter = q->used < q->max_items && q->put_waiters > 0;
+	q->stats.put_calls++;
+	q->stats.items += done;
+	q->stats.wakeups += wake_getter + wake_putter;
+	k_spin_unlock(&q->lock, key);
+
+	if (wake_getter) {
+		k_sem_give(&q->not_empty);
+	}
+	if (wake_putter) {
+		k_sem_give(&q->not_full);
+	}
+
+	return done;
+}
+
+size_t batchq_get(struct batchq *q, void *items, size_t max,
+		  k_timeout_t timeout)
+{
+	k_timepoint_t end = sys_timepoint_calc(timeout);
+	k_spinlock_key_t key;
+	uint32_t k;
+	bool wake_putter, wake_getter;
+
+	/*
+	 * Only an empty queue makes a consumer block, and it has freed no slots
+	 * yet at that point, so there is no producer to wake first.
+	 */
+	key = k_spin_lock(&q->lock);
+	while (q->used == 0 && !K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+		if (wait(q, &key, &q->not_empty, &q->get_waiters, NULL,
+			 end) != 0) {
+			break;
+		}
+	}
+
+	k = MIN(max, q->used);
+	copy_out(q, items, k);
+
+	wake_putter = k > 0 && q->put_waiters > 0;
+	/* items left for another consumer: pass the wakeup on */
+	wake_getter = q->used > 0 && q->get_waiters > 0;
+	q->stats.get_calls++;
+	q->stats.wakeups += wake_putter + wake_getter;
+	k_spin_unlock(&q->lock, key);
+
+	if (wake_putter) {
+		k_sem_give(&q->not_full);
+	}
+	if (wake_getter) {
+		k_sem_give(&q->not_empty);
+	}
+
+	return k;
+}
+
+uint32_t batchq_num_used_get(struct batchq *q)
+{
+	return q->used;
+}
+
+void batchq_stats_take(struct batchq *q, struct batchq_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&q->lock);
+
+	*stats = q->stats;
+	memset(&q->stats, 0, sizeof(q->stats));
+	k_spin_unlock(&q->lock, key);
+}
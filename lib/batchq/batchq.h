@@ -0,0 +1,79 @@
+#ifndef BATCHQ_H_
+#define BATCHQ_H_
+
+#include <zephyr/kernel.h>
+
+/*
+ * Message queue with batch put and get.
+ *
+ * k_msgq moves one item per call: every item pays for the lock, the
+ * wait queue check and possibly a reschedule. batchq_put() and
+ * batchq_get() move up to n items per lock acquisition and wake the other
+ * side once for all of them, so a burst costs about as much as a single
+ * item.
+ *
+ * Waiters block on two binary semaphores, one per direction, that are only
+ * given when a thread is known to wait on them. A put that does not fit
+ * wakes a consumer each time it has to block, and once more at the end
+ * for the items queued since. A woken thread that leaves room or items
+ * behind also passes the wakeup on to the next waiter on its own side, so
+ * several producers and consumers can share a queue.
+ *
+ * Items are copied in and out, like with k_msgq. Only kernel threads can
+ * use a batchq; it is not a kernel object.
+ */
+
+struct batchq_stats {
+	uint32_t put_calls;
+	uint32_t get_calls;
+	uint32_t items;
+	uint32_t waits;         /* times a caller had to block */
+	uint32_t wakeups;       /* semaphore gives */
+};
+
+struct batchq {
+	struct k_spinlock lock;
+	uint8_t *buf;
+	size_t item_size;
+	uint32_t max_items;
+	uint32_t head;          /* next slot written */
+	uint32_t used;
+	uint32_t put_waiters;
+	uint32_t get_waiters;
+	struct k_sem not_full;
+	struct k_sem not_empty;
+	struct batchq_stats stats;
+};
+
+#define BATCHQ_DEFINE(_name, _item_size, _max_items)			 \
+	static uint8_t _name##_buf[(_max_items) * (_item_size)] __aligned(4); \
+	struct batchq _name = {						 \
+		.buf = _name##_buf,					 \
+		.item_size = (_item_size),				 \
+		.max_items = (_max_items),				 \
+		.not_full = Z_SEM_INITIALIZER(_name.not_full, 0, 1),	 \
+		.not_empty = Z_SEM_INITIALIZER(_name.not_empty, 0, 1),	 \
+	}
+
+/*
+ * Copy n items in, waiting for room until all of them are queued or the
+ * timeout expires. Returns the number of items queued, which is less than
+ * n only on timeout (0..n-1; with K_NO_WAIT, whatever fitted).
+ */
+size_t batchq_put(struct batchq *q, const void *items, size_t n,
+		  k_timeout_t timeout);
+
+/*
+ * Wait until at least one item is queued, or the timeout expires, then
+ * copy out up to max items. Returns the number of items copied, 0 on
+ * timeout.
+ */
+size_t batchq_get(struct batchq *q, void *items, size_t max,
+		  k_timeout_t timeout);
+
+uint32_t batchq_num_used_get(struct batchq *q);
+
+/* Copy the counters into *stats and reset them. */
+void batchq_stats_take(struct batchq *q, struct batchq_stats *stats);
+
+#endif /* BATCHQ_H_ */
@@ -0,0 +1,89 @@
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+
+#include "bootprof.h"
+
+static const char *const names[BOOTPROF_COUNT] = {
+	[BOOTPROF_KERNEL] = "kernel start",
+	[BOOTPROF_DEVICES] = "device init",
+	[BOOTPROF_MAIN] = "main",
+	[BOOTPROF_FIRST_THREAD] = "first thread",
+	[BOOTPROF_FIRST_GPIO] = "first gpio write",
+	[BOOTPROF_FIRST_UART] = "first uart byte",
+};
+
+static uint32_t stamps[BOOTPROF_COUNT];
+static ATOMIC_DEFINE(marked, BOOTPROF_COUNT);
+static atomic_t reported;
+
+void bootprof_mark(enum bootprof_milestone m)
+{
+	uint32_t now;
+
+	if (IS_ENABLED(CONFIG_USERSPACE) && k_is_user_context()) {
+		return;
+	}
+
+	now = k_cycle_get_32();
+	if (!atomic_test_and_set_bit(marked, m)) {
+		stamps[m] = now;
+	}
+}
+
+void bootprof_report(void)
+{
+	uint32_t first_output = UINT32_MAX;
+
+	if (IS_ENABLED(CONFIG_USERSPACE) && k_is_user_context()) {
+		return;
+	}
+	if (!atomic_cas(&reported, 0, 1)) {
+		return;
+	}
+
+	printk("boot profile, us since kernel start:\n");
+	for (int m = 0; m < BOOTPROF_COUNT; m++) {
+		if (atomic_test_bit(marked, m)) {
+			printk("  %-16s %8u\n", names[m],
+			       k_cyc_to_us_floor32(stamps[m] - stamps[BOOTPROF_KERNEL]));
+		}
+	}
+
+	for (int m = BOOTPROF_FIRST_GPIO; m <= BOOTPROF_FIRST_UART; m++) {
+		if (atomic_test_bit(marked, m)) {
+			first_output = MIN(first_output,
+					   stamps[m] - stamps[BOOTPROF_KERNEL]);
+		}
+	}
+	if (first_output != UINT32_MAX) {
+		printk("time to first output %u us\n",
+		       k_cyc_to_us_floor32(first_output));
+	}
+}
+
+static int bootprof_kernel(void)
+{
+	bootprof_mark(BOOTPROF_KERNEL);
+	return 0;
+}
+
+/* right after the system clock driver, which uses priority 0 */
+SYS_INIT(bootprof_kernel, PRE_KERNEL_2, 1);
+
+static int bootprof_devices(void)
+{
+	bootprof_mark(BOOTPROF_DEVICES);
+	return 0;
+}
+
+/*
+ * Marks the end of device init: every PRE_KERNEL and POST_KERNEL driver
+ * has run, and so has every APPLICATION hook with a lower priority (the
+ * app's SYS_INIT hooks at CONFIG_APPLICATION_INIT_PRIORITY, 90 by
+ * default). This is not necessarily the last hook. Others at priority
+ * 99 run in link order, before or after this one, and the static threads
+ * only start after all of them.
+ */
+SYS_INIT(bootprof_devices, APPLICATION, 99);
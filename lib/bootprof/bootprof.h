@@ -0,0 +1,46 @@
+#ifndef BOOTPROF_H_
+#define BOOTPROF_H_
+
+#include <zephyr/kernel.h>
+
+/*
+ * Boot profile.
+ *
+ * Records the cycle counter at a few milestones between reset and the
+ * first thing the app shows to the outside world. The kernel and device
+ * milestones are recorded by SYS_INIT hooks in bootprof.c; the app marks
+ * the rest where they happen. Only the first mark of each kind counts, so
+ * marking from a loop or from several threads is fine.
+ *
+ *	gpio_pin_configure_dt(&led0, GPIO_OUTPUT_ACTIVE);
+ *	bootprof_mark(BOOTPROF_FIRST_GPIO);
+ *	bootprof_report();
+ *
+ * Times are counted from BOOTPROF_KERNEL, the first point where the cycle
+ * counter runs (right after the system clock driver is initialised), so
+ * whatever the boot ROM and early startup code spend is not included.
+ *
+ * Marks and reports from user threads are ignored: they can read neither
+ * the cycle counter nor the profile.
+ */
+
+enum bootprof_milestone {
+	BOOTPROF_KERNEL,        /* system clock up, PRE_KERNEL_2 */
+	BOOTPROF_DEVICES,       /* drivers and lower-priority APPLICATION hooks done */
+	BOOTPROF_MAIN,          /* main() entered */
+	BOOTPROF_FIRST_THREAD,  /* first app thread running */
+	BOOTPROF_FIRST_GPIO,    /* first GPIO pin driven */
+	BOOTPROF_FIRST_UART,    /* first write to the UART or console starts */
+	BOOTPROF_COUNT
+};
+
+void bootprof_mark(enum bootprof_milestone m);
+
+/*
+ * Print every milestone reached so far and the time to first output (the
+ * earlier of the first GPIO write and the first UART byte). Only the first
+ * call prints, so it can sit on a path that runs more than once.
+ */
+void bootprof_report(void);
+
+#endif /* BOOTPROF_H_ */
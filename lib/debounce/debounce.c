@@ -0,0 +1,16 @@
+#include "debounce.h"
+
+bool debounce_sample(struct debounce *db, bool pressed)
+{
+	bool accepted = false;
+
+	if (db->pending) {
+		db->pending = false;
+		accepted = pressed;
+	} else if (pressed && !db->last) {
+		db->pending = true;
+	}
+	db->last = pressed;
+
+	return accepted;
+}
@@ -0,0 +1,23 @@
+#ifndef DEBOUNCE_H_
+#define DEBOUNCE_H_
+
+#include <stdbool.h>
+
+/*
+ * Button debouncing on periodic samples.
+ *
+ * Feed one sample per poll period. A released -> pressed edge is only
+ * accepted if the button still reads pressed on the following sample, so
+ * the poll period is the debounce time: bounces shorter than one period
+ * are ignored, and a press is reported at most two periods after the
+ * contact settles.
+ */
+struct debounce {
+	bool last;
+	bool pending;
+};
+
+/* Returns true when a press is accepted on this sample. */
+bool debounce_sample(struct debounce *db, bool pressed);
+
+#endif /* DEBOUNCE_H_ */
@@ -0,0 +1,108 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#include "periodic.h"
+
+/*
+ * The wakeup lands on the release tick itself, so measuring it in ticks
+ * always gives 0. The cycle counter behind k_cycle_get_32() runs from
+ * boot in step with the tick count (tick n starts at cycle
+ * n * cycles-per-tick), so the release instant is known in cycles too,
+ * and the difference is the sub-tick latency from the timer interrupt to
+ * the thread running. The 32-bit difference is right as long as the
+ * latency stays below one wrap of the counter.
+ *
+ * User threads cannot read the cycle counter (HPET on qemu_x86), so for
+ * them the latency falls back to whole ticks.
+ */
+static uint32_t wake_latency_us(k_ticks_t release)
+{
+	uint32_t release_cycles;
+
+	if (IS_ENABLED(CONFIG_USERSPACE) && k_is_user_context()) {
+		return k_ticks_to_us_floor32(k_uptime_ticks() - release);
+	}
+
+	release_cycles = (uint32_t)k_ticks_to_cyc_floor64(release);
+
+	return k_cyc_to_us_floor32(k_cycle_get_32() - release_cycles);
+}
+
+static void release_job(struct periodic_task *task)
+{
+	uint32_t jitter;
+
+	k_sleep(K_TIMEOUT_ABS_TICKS(task->release));
+
+	jitter = wake_latency_us(task->release);
+
+	task->stats.releases++;
+	task->stats.jitter_sum += jitter;
+	if (jitter > task->stats.jitter_max) {
+		task->stats.jitter_max = jitter;
+	}
+
+#ifdef CONFIG_SCHED_DEADLINE
+	/* k_thread_deadline_set() takes a deadline relative to now */
+	int64_t left = task->release + task->deadline - k_uptime_ticks();
+
+	k_thread_deadline_set(k_current_get(),
+			      left > 0 ? (int)k_ticks_to_cyc_ceil32(left) : 0);
+#endif
+}
+
+void periodic_task_start(struct periodic_task *task)
+{
+	int64_t now = k_uptime_ticks();
+	k_ticks_t offset = k_ms_to_ticks_ceil64(task->offset_ms);
+
+	task->period = k_ms_to_ticks_ceil64(task->period_ms);
+	task->deadline = task->deadline_ms ?
+			 k_ms_to_ticks_ceil64(task->deadline_ms) : task->period;
+
+	/* align on the period grid so tasks sharing a period stay in phase */
+	task->release = ((now - offset) / task->period + 1) * task->period + offset;
+
+	release_job(task);
+}
+
+void periodic_task_wait(struct periodic_task *task)
+{
+	int64_t now = k_uptime_ticks();
+	int64_t elapsed = now - task->release;
+	uint32_t resp = k_ticks_to_us_floor32(elapsed);
+
+	task->stats.jobs++;
+	task->stats.resp_sum += resp;
+	if (resp > task->stats.resp_max) {
+		task->stats.resp_max = resp;
+	}
+	if (elapsed > task->deadline) {
+		task->stats.misses++;
+	}
+
+	task->release += task->period;
+	if (task->release <= now) {
+		int64_t behind = (now - task->release) / task->period + 1;
+
+		task->release += behind * task->period;
+		task->stats.skipped += behind;
+	}
+
+	release_job(task);
+}
+
+void periodic_task_report(const struct periodic_task *task)
+{
+	const struct periodic_stats *s = &task->stats;
+
+	if (s->releases == 0 || s->jobs == 0) {
+		return;
+	}
+
+	printk("%s: period %u ms, jobs %u, misses %u, skipped %u, "
+	       "jitter avg/max %u/%u us, response avg/max %u/%u us\n",
+	       task->name, task->period_ms, s->jobs, s->misses, s->skipped,
+	       (uint32_t)(s->jitter_sum / s->releases), s->jitter_max,
+	       (uint32_t)(s->resp_sum / s->jobs), s->resp_max);
+}
@@ -0,0 +1,71 @@
+#ifndef PERIODIC_H_
+#define PERIODIC_H_
+
+#include <zephyr/kernel.h>
+
+/*
+ * Periodic task helper.
+ *
+ * Jobs are released on absolute tick deadlines (a multiple of the period
+ * counted from boot, plus an optional offset), so the time spent doing the
+ * work never pushes the next release back the way "work, then k_msleep()"
+ * does. Needs CONFIG_TIMEOUT_64BIT (the default) for absolute timeouts.
+ *
+ * With CONFIG_SCHED_DEADLINE enabled the thread's EDF deadline is refreshed
+ * on every release, so threads of the same priority are ordered by deadline.
+ *
+ * Typical use from a thread:
+ *
+ *	periodic_task_start(&task);
+ *	while (1) {
+ *		do_work();
+ *		periodic_task_wait(&task);
+ *	}
+ */
+
+struct periodic_stats {
+	uint32_t releases;      /* jobs released */
+	uint32_t jobs;          /* jobs completed */
+	uint32_t misses;        /* jobs completed after their deadline */
+	uint32_t skipped;       /* releases dropped because a job overran */
+	uint32_t jitter_max;    /* release -> thread running, us */
+	uint64_t jitter_sum;
+	uint32_t resp_max;      /* release -> job completed, us */
+	uint64_t resp_sum;
+};
+
+struct periodic_task {
+	const char *name;
+	uint32_t period_ms;
+	uint32_t deadline_ms;   /* 0 means "same as the period" */
+	uint32_t offset_ms;     /* phase inside the period */
+
+	/* filled in by periodic_task_start() */
+	k_ticks_t period;
+	k_ticks_t deadline;
+	k_ticks_t release;      /* absolute release of the current job */
+
+	struct periodic_stats stats;
+};
+
+#define PERIODIC_TASK_DEFINE(_name, _period_ms, _deadline_ms, _offset_ms) \
+	struct periodic_task _name = {					   \
+		.name = #_name,						   \
+		.period_ms = (_period_ms),				   \
+		.deadline_ms = (_deadline_ms),				   \
+		.offset_ms = (_offset_ms),				   \
+	}
+
+/* Sleep until the first release and start the first job. */
+void periodic_task_start(struct periodic_task *task);
+
+/*
+ * Close the current job (response time, deadline check) and sleep until
+ * the next release. If the job overran, releases already in the past are
+ * skipped rather than fired back to back.
+ */
+void periodic_task_wait(struct periodic_task *task);
+
+void periodic_task_report(const struct periodic_task *task);
+
+#endif /* PERIODIC_H_ */
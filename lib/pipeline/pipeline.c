@@ -0,0 +1,121 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#include "pipeline.h"
+
+static void add_cycles(struct pipeline_stats *s, uint64_t *sum, uint32_t cycles)
+{
+	k_spinlock_key_t key = k_spin_lock(&s->time_lock);
+
+	*sum += cycles;
+	k_spin_unlock(&s->time_lock, key);
+}
+
+static size_t take_batch(struct pipeline_stage *st)
+{
+	struct k_msgq *in = st->in;
+	uint8_t *buf = st->in_buf;
+	atomic_val_t used = k_msgq_num_used_get(in);
+	atomic_val_t max;
+	size_t n = 1;
+
+	atomic_add(&st->stats.occupancy_sum, used);
+	do {
+		max = atomic_get(&st->stats.occupancy_max);
+	} while (used > max && !atomic_cas(&st->stats.occupancy_max, max, used));
+
+	/* block for the first item, then take what is already there */
+	k_msgq_get(in, buf, K_FOREVER);
+	while (n < st->batch &&
+	       k_msgq_get(in, buf + n * in->msg_size, K_NO_WAIT) == 0) {
+		n++;
+	}
+
+	return n;
+}
+
+static void put_batch(struct pipeline_stage *st, size_t n)
+{
+	struct k_msgq *out = st->out;
+	const uint8_t *buf = st->out_buf;
+	uint32_t start = k_cycle_get_32();
+
+	for (size_t i = 0; i < n; i++) {
+		k_msgq_put(out, buf + i * out->msg_size, K_FOREVER);
+	}
+
+	add_cycles(&st->stats, &st->stats.stall_cycles, k_cycle_get_32() - start);
+}
+
+void pipeline_stage_run(void *stage, void *unused1, void *unused2)
+{
+	struct pipeline_stage *st = stage;
+	size_t n_in, n_out;
+	uint32_t start;
+
+	ARG_UNUSED(unused1);
+	ARG_UNUSED(unused2);
+
+	while (1) {
+		n_in = st->in ? take_batch(st) : 0;
+
+		start = k_cycle_get_32();
+		n_out = st->fn(st->in_buf, n_in, st->out_buf,
+			       st->out ? st->batch : 0);
+		add_cycles(&st->stats, &st->stats.busy_cycles,
+			   k_cycle_get_32() - start);
+
+		atomic_inc(&st->stats.calls);
+		atomic_add(&st->stats.items_in, n_in);
+		atomic_add(&st->stats.items_out, n_out);
+
+		if (st->out) {
+			put_batch(st, n_out);
+		}
+	}
+}
+
+void pipeline_report(struct pipeline_stage *const stages[], size_t n,
+		     uint32_t window_ms)
+{
+	uint64_t window_us = (uint64_t)window_ms * 1000;
+	const char *bottleneck = NULL;
+	uint32_t busiest = 0;
+
+	for (size_t i = 0; i < n; i++) {
+		struct pipeline_stats *live = &stages[i]->stats;
+		uint32_t calls = atomic_clear(&live->calls);
+		uint32_t items_in = atomic_clear(&live->items_in);
+		uint32_t items_out = atomic_clear(&live->items_out);
+		uint32_t occupancy_sum = atomic_clear(&live->occupancy_sum);
+		uint32_t occupancy_max = atomic_clear(&live->occupancy_max);
+		uint32_t items = stages[i]->in ? items_in : items_out;
+		k_spinlock_key_t key = k_spin_lock(&live->time_lock);
+		uint64_t busy_cycles = live->busy_cycles;
+		uint64_t stall_cycles = live->stall_cycles;
+		uint32_t busy, stall;
+
+		live->busy_cycles = 0;
+		live->stall_cycles = 0;
+		k_spin_unlock(&live->time_lock, key);
+
+		busy = (uint32_t)(k_cyc_to_us_floor64(busy_cycles) * 100 / window_us);
+		stall = (uint32_t)(k_cyc_to_us_floor64(stall_cycles) * 100 / window_us);
+
+		if (busy >= busiest) {
+			busiest = busy;
+			bottleneck = stages[i]->name;
+		}
+
+		printk("%-10s %6u items/s, batch avg %2u, queue avg/max %2u/%2u, "
+		       "busy %3u%%, stalled %3u%%\n",
+		       stages[i]->name, items * 1000 / window_ms,
+		       calls ? items / calls : 0,
+		       calls ? occupancy_sum / calls : 0, occupancy_max,
+		       busy, stall);
+	}
+
+	if (bottleneck) {
+		printk("bottleneck: %s (%u%% busy)\n", bottleneck, busiest);
+	}
+}
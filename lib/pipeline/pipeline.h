@@ -0,0 +1,114 @@
+#ifndef PIPELINE_H_
+#define PIPELINE_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+/*
+ * N-stage processing pipeline.
+ *
+ * Stages and the queues between them are declared at compile time. Every
+ * stage is a thread that blocks for one input item, takes whatever else is
+ * already queued (up to its batch size), hands the batch to its stage
+ * function and puts the results on its output queue, blocking while that
+ * queue is full. The first stage has no input queue and produces items on
+ * its own; the last one has no output queue.
+ *
+ *	PIPELINE_QUEUE_DEFINE(raw_q, struct sample, 16);
+ *	PIPELINE_QUEUE_DEFINE(out_q, struct frame, 16);
+ *
+ *	PIPELINE_SOURCE_DEFINE(acquire, acquire_fn, raw_q, struct sample, 4, 7);
+ *	PIPELINE_STAGE_DEFINE(encode, encode_fn, raw_q, struct sample,
+ *			      out_q, struct frame, 4, 7);
+ *	PIPELINE_SINK_DEFINE(transmit, transmit_fn, out_q, struct frame, 4, 7);
+ *
+ * Per-stage counters show where the time goes: the bottleneck is the stage
+ * that is busy nearly all the time, with a full input queue and an output
+ * queue that stays empty.
+ */
+
+#ifndef PIPELINE_STACK_SIZE
+#define PIPELINE_STACK_SIZE 1024
+#endif
+
+/*
+ * Process n_in items from `in` (n_in is 0 for the source stage) and write
+ * up to max_out items to `out` (NULL for the sink). Returns the number of
+ * items written.
+ */
+typedef size_t (*pipeline_stage_fn)(const void *in, size_t n_in,
+				    void *out, size_t max_out);
+
+/*
+ * The counts are atomics, so pipeline_report() can read and clear them
+ * with atomic_clear() while the stage keeps counting: nothing is lost or
+ * torn. The times are raw cycle sums, converted once per report so that
+ * calls shorter than a microsecond still add up; being 64-bit they sit
+ * behind time_lock.
+ */
+struct pipeline_stats {
+	atomic_t calls;
+	atomic_t items_in;
+	atomic_t items_out;
+	atomic_t occupancy_sum;   /* input queue depth, sampled per call */
+	atomic_t occupancy_max;
+	struct k_spinlock time_lock;
+	uint64_t busy_cycles;     /* inside the stage function */
+	uint64_t stall_cycles;    /* blocked on a full output queue */
+};
+
+struct pipeline_stage {
+	const char *name;
+	pipeline_stage_fn fn;
+	struct k_msgq *in;        /* NULL for the source */
+	struct k_msgq *out;       /* NULL for the sink */
+	void *in_buf;
+	void *out_buf;
+	size_t batch;
+	struct pipeline_stats stats;
+};
+
+void pipeline_stage_run(void *stage, void *unused1, void *unused2);
+
+#define PIPELINE_QUEUE_DEFINE(_name, _type, _depth) \
+	K_MSGQ_DEFINE(_name, sizeof(_type), _depth, 4)
+
+#define PIPELINE_STAGE_INIT(_name, _fn, _in, _in_buf, _out, _out_buf, _batch, _prio) \
+	struct pipeline_stage _name = {						    \
+		.name = #_name,							    \
+		.fn = (_fn),							    \
+		.in = (_in),							    \
+		.out = (_out),							    \
+		.in_buf = (_in_buf),						    \
+		.out_buf = (_out_buf),						    \
+		.batch = (_batch),						    \
+	};									    \
+	K_THREAD_DEFINE(_name##_thread, PIPELINE_STACK_SIZE,			    \
+			pipeline_stage_run, &_name, NULL, NULL,			    \
+			_prio, 0, 0)
+
+#define PIPELINE_SOURCE_DEFINE(_name, _fn, _out, _out_type, _batch, _prio)	    \
+	static _out_type _name##_out_buf[_batch];				    \
+	PIPELINE_STAGE_INIT(_name, _fn, NULL, NULL, &_out, _name##_out_buf,	    \
+			    _batch, _prio)
+
+#define PIPELINE_STAGE_DEFINE(_name, _fn, _in, _in_type, _out, _out_type,	    \
+			      _batch, _prio)					    \
+	static _in_type _name##_in_buf[_batch];					    \
+	static _out_type _name##_out_buf[_batch];				    \
+	PIPELINE_STAGE_INIT(_name, _fn, &_in, _name##_in_buf, &_out,		    \
+			    _name##_out_buf, _batch, _prio)
+
+#define PIPELINE_SINK_DEFINE(_name, _fn, _in, _in_type, _batch, _prio)	    \
+	static _in_type _name##_in_buf[_batch];					    \
+	PIPELINE_STAGE_INIT(_name, _fn, &_in, _name##_in_buf, NULL, NULL,	    \
+			    _batch, _prio)
+
+/*
+ * Print the counters of every stage for the last window_ms and reset them,
+ * naming the busiest stage as the bottleneck.
+ */
+void pipeline_report(struct pipeline_stage *const stages[], size_t n,
+		     uint32_t window_ms);
+
+#endif /* PIPELINE_H_ */
@@ -0,0 +1,130 @@
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#include "reactor.h"
+
+static int add_source(struct reactor *r, struct reactor_source *src,
+		      const char *name, reactor_handler_t handler,
+		      uint32_t type, void *obj)
+{
+	if (r->count >= REACTOR_MAX_SOURCES) {
+		return -ENOMEM;
+	}
+
+	src->name = name;
+	src->handler = handler;
+	src->stamp = 0;
+	src->dispatches = 0;
+	src->measured = 0;
+	src->latency_max = 0;
+	src->latency_sum = 0;
+
+	k_poll_event_init(&r->events[r->count], type,
+			  K_POLL_MODE_NOTIFY_ONLY, obj);
+	r->sources[r->count] = src;
+	r->count++;
+
+	return 0;
+}
+
+void reactor_init(struct reactor *r)
+{
+	r->count = 0;
+}
+
+int reactor_add_signal(struct reactor *r, struct reactor_source *src,
+		       const char *name, reactor_handler_t handler)
+{
+	k_poll_signal_init(&src->signal);
+	src->msgq = NULL;
+
+	return add_source(r, src, name, handler,
+			  K_POLL_TYPE_SIGNAL, &src->signal);
+}
+
+int reactor_add_msgq(struct reactor *r, struct reactor_source *src,
+		     const char *name, struct k_msgq *msgq,
+		     reactor_handler_t handler)
+{
+	src->msgq = msgq;
+
+	return add_source(r, src, name, handler,
+			  K_POLL_TYPE_MSGQ_DATA_AVAILABLE, msgq);
+}
+
+static void timer_expired(struct k_timer *timer)
+{
+	struct reactor_timer *t = CONTAINER_OF(timer, struct reactor_timer, timer);
+
+	reactor_raise(&t->src);
+}
+
+int reactor_add_timer(struct reactor *r, struct reactor_timer *t,
+		      const char *name, reactor_handler_t handler)
+{
+	k_timer_init(&t->timer, timer_expired, NULL);
+
+	return reactor_add_signal(r, &t->src, name, handler);
+}
+
+void reactor_raise(struct reactor_source *src)
+{
+	reactor_stamp(src);
+	k_poll_signal_raise(&src->signal, 0);
+}
+
+static void dispatch(struct reactor_source *src)
+{
+	uint32_t stamp = src->stamp;
+	uint32_t latency;
+
+	if (stamp != 0) {
+		latency = k_cycle_get_32() - stamp;
+		src->measured++;
+		src->latency_sum += latency;
+		if (latency > src->latency_max) {
+			src->latency_max = latency;
+		}
+	}
+	src->dispatches++;
+
+	/* clear before the handler so a raise during it is not lost */
+	src->stamp = 0;
+	if (src->msgq == NULL) {
+		k_poll_signal_reset(&src->signal);
+	}
+
+	src->handler(src);
+}
+
+void reactor_run(struct reactor *r)
+{
+	while (1) {
+		k_poll(r->events, r->count, K_FOREVER);
+
+		for (int i = 0; i < r->count; i++) {
+			if (r->events[i].state == K_POLL_STATE_NOT_READY) {
+				continue;
+			}
+			r->events[i].state = K_POLL_STATE_NOT_READY;
+			dispatch(r->sources[i]);
+		}
+	}
+}
+
+void reactor_report(const struct reactor *r)
+{
+	for (int i = 0; i < r->count; i++) {
+		const struct reactor_source *src = r->sources[i];
+
+		if (src->measured == 0) {
+			printk("%s: %u dispatches\n", src->name, src->dispatches);
+			continue;
+		}
+		printk("%s: %u dispatches, latency avg/max %u/%u ns\n",
+		       src->name, src->dispatches,
+		       (uint32_t)k_cyc_to_ns_floor64(src->latency_sum / src->measured),
+		       (uint32_t)k_cyc_to_ns_floor64(src->latency_max));
+	}
+}
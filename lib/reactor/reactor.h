@@ -0,0 +1,83 @@
+#ifndef REACTOR_H_
+#define REACTOR_H_
+
+#include <zephyr/kernel.h>
+
+/*
+ * Single-thread event reactor.
+ *
+ * One thread sleeps in k_poll() on every registered source and calls the
+ * source's handler when it fires, so several behaviours can share a single
+ * stack instead of each owning a thread. Three kinds of source:
+ *
+ *	signal: raised from anywhere (typically an ISR) with reactor_raise()
+ *	msgq:   fires while the queue has data; the handler must drain it
+ *	timer:  a k_timer whose expiry raises the source
+ *
+ * Handlers run in the reactor thread and must not block, or every other
+ * source waits with them. Needs CONFIG_POLL.
+ */
+
+#ifndef REACTOR_MAX_SOURCES
+#define REACTOR_MAX_SOURCES 8
+#endif
+
+struct reactor_source;
+
+typedef void (*reactor_handler_t)(struct reactor_source *src);
+
+struct reactor_source {
+	const char *name;
+	reactor_handler_t handler;
+	struct k_poll_signal signal;  /* signal and timer sources */
+	struct k_msgq *msgq;          /* msgq sources */
+
+	uint32_t stamp;               /* cycles when first raised, 0 if not */
+	uint32_t dispatches;
+	uint32_t measured;            /* dispatches that had a stamp */
+	uint32_t latency_max;         /* raise -> handler, cycles */
+	uint64_t latency_sum;
+};
+
+struct reactor_timer {
+	struct reactor_source src;
+	struct k_timer timer;
+};
+
+struct reactor {
+	struct k_poll_event events[REACTOR_MAX_SOURCES];
+	struct reactor_source *sources[REACTOR_MAX_SOURCES];
+	int count;
+};
+
+void reactor_init(struct reactor *r);
+
+/* Each returns 0, or -ENOMEM when REACTOR_MAX_SOURCES are in use. */
+int reactor_add_signal(struct reactor *r, struct reactor_source *src,
+		       const char *name, reactor_handler_t handler);
+int reactor_add_msgq(struct reactor *r, struct reactor_source *src,
+		     const char *name, struct k_msgq *msgq,
+		     reactor_handler_t handler);
+int reactor_add_timer(struct reactor *r, struct reactor_timer *t,
+		      const char *name, reactor_handler_t handler);
+
+/* ISR safe. Raises pending before the reactor runs are coalesced. */
+void reactor_raise(struct reactor_source *src);
+
+/*
+ * Record the raise time of a msgq source, so its dispatch latency is
+ * measured too. Call it next to the k_msgq_put(); ISR safe.
+ */
+static inline void reactor_stamp(struct reactor_source *src)
+{
+	if (src->stamp == 0) {
+		src->stamp = k_cycle_get_32();
+	}
+}
+
+/* Dispatch events forever from the calling thread. */
+void reactor_run(struct reactor *r);
+
+void reactor_report(const struct reactor *r);
+
+#endif /* REACTOR_H_ */
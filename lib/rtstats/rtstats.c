@@ -0,0 +1,298 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+#endif
+
+#include "rtstats.h"
+
+#define OVERHEAD_LOOPS 10000
+
+static sys_slist_t entries = SYS_SLIST_STATIC_INIT(&entries);
+static struct k_spinlock entries_lock;
+
+/*
+ * Uptime at the previous snapshot, for the CPU share of each thread. It and
+ * every rtstats_thread.last_cycles form one baseline that the shell
+ * command, the stream and direct callers all move on, so a snapshot takes
+ * print_lock from start to end. That is a mutex, not a spinlock, because
+ * printing to the shell can block.
+ */
+static int64_t last_ticks;
+static K_MUTEX_DEFINE(print_lock);
+
+static const struct shell *stream_sh;
+static uint32_t stream_ms;
+
+static void out(const struct shell *sh, const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+#if defined(CONFIG_SHELL)
+	if (sh) {
+		shell_vfprintf(sh, SHELL_NORMAL, fmt, ap);
+		va_end(ap);
+		return;
+	}
+#endif
+	vprintk(fmt, ap);
+	va_end(ap);
+}
+
+uint32_t rtstats_counter_get(const struct rtstats_counter *c)
+{
+	uint32_t sum = 0;
+
+	for (int i = 0; i < ARRAY_SIZE(c->cpu); i++) {
+		sum += (uint32_t)atomic_get(&c->cpu[i].value);
+	}
+	return sum;
+}
+
+static void add_entry(struct rtstats_entry *e, const char *name,
+		      enum rtstats_kind kind)
+{
+	k_spinlock_key_t key = k_spin_lock(&entries_lock);
+
+	e->name = name;
+	e->kind = kind;
+	sys_slist_append(&entries, &e->node);
+
+	k_spin_unlock(&entries_lock, key);
+}
+
+void rtstats_register_thread(struct rtstats_thread *t, const char *name,
+			     k_tid_t tid)
+{
+	t->tid = tid;
+	t->last_cycles = 0;
+	add_entry(&t->entry, name, RTSTATS_THREAD);
+}
+
+void rtstats_register_msgq(struct rtstats_msgq *q, const char *name,
+			   struct k_msgq *msgq)
+{
+	q->msgq = msgq;
+	add_entry(&q->entry, name, RTSTATS_MSGQ);
+}
+
+void rtstats_register_mutex(struct rtstats_mutex *m, const char *name,
+			    struct k_mutex *mutex)
+{
+	m->mutex = mutex;
+	add_entry(&m->entry, name, RTSTATS_MUTEX);
+}
+
+static void print_thread(const struct shell *sh, struct rtstats_thread *t,
+			 uint64_t window_cycles)
+{
+	k_thread_runtime_stats_t rt;
+	uint64_t used;
+	uint32_t permille;
+
+	if (k_thread_runtime_stats_get(t->tid, &rt) != 0) {
+		return;
+	}
+
+	used = rt.execution_cycles - t->last_cycles;
+	t->last_cycles = rt.execution_cycles;
+	permille = window_cycles ? (uint32_t)(used * 1000 / window_cycles) : 0;
+
+	out(sh, "  %-12s cpu %3u.%u%%, total %u ms\n", t->entry.name,
+	    permille / 10, permille % 10,
+	    (uint32_t)(k_cyc_to_ns_floor64(rt.execution_cycles) / 1000000));
+}
+
+static void print_msgq(const struct shell *sh, struct rtstats_msgq *q)
+{
+	out(sh, "  %-12s used %u/%u, max %u, puts %u, full %u\n", q->entry.name,
+	    k_msgq_num_used_get(q->msgq), q->msgq->max_msgs,
+	    (uint32_t)atomic_get(&q->max_used),
+	    rtstats_counter_get(&q->puts), rtstats_counter_get(&q->full));
+}
+
+static void print_mutex(const struct shell *sh, struct rtstats_mutex *m)
+{
+	uint32_t locks = rtstats_counter_get(&m->locks);
+	uint32_t timeouts = rtstats_counter_get(&m->timeouts);
+	uint32_t waited = rtstats_counter_get(&m->wait_us);
+
+	out(sh, "  %-12s locks %u, timeouts %u, wait avg %u us\n", m->entry.name,
+	    locks, timeouts, waited / MAX(locks + timeouts, 1));
+}
+
+void rtstats_print(const struct shell *sh)
+{
+	int64_t now;
+	uint64_t window_cycles;
+	struct rtstats_entry *e;
+
+	k_mutex_lock(&print_lock, K_FOREVER);
+
+	now = k_uptime_ticks();
+	window_cycles = k_ticks_to_cyc_floor64(now - last_ticks) *
+			CONFIG_MP_MAX_NUM_CPUS;
+
+	out(sh, "rtstats at %u ms, window %u ms\n",
+	    (uint32_t)k_ticks_to_ms_floor64(now),
+	    (uint32_t)k_ticks_to_ms_floor64(now - last_ticks));
+	last_ticks = now;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&entries, e, node) {
+		switch (e->kind) {
+		case RTSTATS_THREAD:
+			print_thread(sh, CONTAINER_OF(e, struct rtstats_thread, entry),
+				     window_cycles);
+			break;
+		case RTSTATS_MSGQ:
+			print_msgq(sh, CONTAINER_OF(e, struct rtstats_msgq, entry));
+			break;
+		case RTSTATS_MUTEX:
+			print_mutex(sh, CONTAINER_OF(e, struct rtstats_mutex, entry));
+			break;
+		}
+	}
+
+	k_mutex_unlock(&print_lock);
+}
+
+static void stream_work_fn(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+
+	if (stream_ms == 0) {
+		return;
+	}
+	rtstats_print(stream_sh);
+	k_work_reschedule(dwork, K_MSEC(stream_ms));
+}
+
+static K_WORK_DELAYABLE_DEFINE(stream_work, stream_work_fn);
+
+void rtstats_stream(const struct shell *sh, uint32_t period_ms)
+{
+	stream_sh = sh;
+	stream_ms = period_ms;
+
+	if (period_ms == 0) {
+		k_work_cancel_delayable(&stream_work);
+	} else {
+		k_work_reschedule(&stream_work, K_MSEC(period_ms));
+	}
+}
+
+/*
+ * Time OVERHEAD_LOOPS uncontended lock/unlock and put/get pairs, plain and
+ * instrumented, on private objects so the app's counters stay untouched.
+ */
+K_MUTEX_DEFINE(overhead_mutex);
+K_MSGQ_DEFINE(overhead_msgq, sizeof(uint32_t), 1, 4);
+
+static uint32_t ns_per_loop(uint32_t start)
+{
+	return (uint32_t)(k_cyc_to_ns_floor64(k_cycle_get_32() - start) /
+			  OVERHEAD_LOOPS);
+}
+
+void rtstats_overhead(const struct shell *sh)
+{
+	static struct rtstats_mutex m = { .mutex = &overhead_mutex };
+	static struct rtstats_msgq q = { .msgq = &overhead_msgq };
+	static struct rtstats_counter c;
+	uint32_t item = 0, start, counter_ns;
+	uint32_t mutex_ns, mutex_stats_ns, msgq_ns, msgq_stats_ns;
+	int32_t mutex_extra, msgq_extra;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < OVERHEAD_LOOPS; i++) {
+		rtstats_counter_add(&c, 1);
+	}
+	counter_ns = ns_per_loop(start);
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < OVERHEAD_LOOPS; i++) {
+		k_mutex_lock(&overhead_mutex, K_FOREVER);
+		k_mutex_unlock(&overhead_mutex);
+	}
+	mutex_ns = ns_per_loop(start);
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < OVERHEAD_LOOPS; i++) {
+		rtstats_mutex_lock(&m, K_FOREVER);
+		k_mutex_unlock(&overhead_mutex);
+	}
+	mutex_stats_ns = ns_per_loop(start);
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < OVERHEAD_LOOPS; i++) {
+		k_msgq_put(&overhead_msgq, &item, K_NO_WAIT);
+		k_msgq_get(&overhead_msgq, &item, K_NO_WAIT);
+	}
+	msgq_ns = ns_per_loop(start);
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < OVERHEAD_LOOPS; i++) {
+		rtstats_msgq_put(&q, &item, K_NO_WAIT);
+		k_msgq_get(&overhead_msgq, &item, K_NO_WAIT);
+	}
+	msgq_stats_ns = ns_per_loop(start);
+
+	mutex_extra = (int32_t)(mutex_stats_ns - mutex_ns);
+	msgq_extra = (int32_t)(msgq_stats_ns - msgq_ns);
+
+	out(sh, "counter add %u ns\n", counter_ns);
+	out(sh, "mutex lock/unlock %u ns, instrumented %u ns (%+d ns)\n",
+	    mutex_ns, mutex_stats_ns, mutex_extra);
+	out(sh, "msgq put/get %u ns, instrumented %u ns (%+d ns)\n",
+	    msgq_ns, msgq_stats_ns, msgq_extra);
+	out(sh, "budget %u ns per operation: %s\n", RTSTATS_BUDGET_NS,
+	    MAX(mutex_extra, msgq_extra) <= RTSTATS_BUDGET_NS ? "ok" : "OVER");
+}
+
+#if defined(CONFIG_SHELL)
+
+static int cmd_show(const struct shell *sh, size_t argc, char **argv)
+{
+	rtstats_print(sh);
+	return 0;
+}
+
+static int cmd_stream(const struct shell *sh, size_t argc, char **argv)
+{
+	if (strcmp(argv[1], "off") == 0) {
+		rtstats_stream(sh, 0);
+		return 0;
+	}
+
+	uint32_t period_ms = strtoul(argv[1], NULL, 10);
+
+	if (period_ms == 0) {
+		shell_error(sh, "period must be a number of ms or 'off'");
+		return -EINVAL;
+	}
+	rtstats_stream(sh, period_ms);
+	return 0;
+}
+
+static int cmd_overhead(const struct shell *sh, size_t argc, char **argv)
+{
+	rtstats_overhead(sh);
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_rtstats,
+	SHELL_CMD(show, NULL, "Print a snapshot", cmd_show),
+	SHELL_CMD_ARG(stream, NULL, "Print a snapshot every <ms>, or 'off'",
+		      cmd_stream, 2, 0),
+	SHELL_CMD(overhead, NULL, "Measure the instrumentation cost", cmd_overhead),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(rtstats, &sub_rtstats, "Runtime statistics", NULL);
+
+#endif /* CONFIG_SHELL */
@@ -0,0 +1,149 @@
+#ifndef RTSTATS_H_
+#define RTSTATS_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/slist.h>
+
+/*
+ * Runtime statistics registry.
+ *
+ * Apps register their threads, message queues and mutexes once at start
+ * up, then go through rtstats_msgq_put() / rtstats_mutex_lock() on the hot
+ * path. Counters are per-CPU atomics, each slot on its own cache line on
+ * SMP, so CPUs never fight over a counter; readers add the slots up.
+ * Thread CPU time comes from the kernel (CONFIG_THREAD_RUNTIME_STATS).
+ *
+ * With CONFIG_SHELL the "rtstats" command prints a snapshot, streams one
+ * every N ms, or measures what the instrumentation costs against
+ * RTSTATS_BUDGET_NS. Entries are never unregistered.
+ *
+ * User threads can call the wrappers as long as the entries sit in memory
+ * they can write. They cannot read the CPU id or the cycle counter, so their
+ * counts all land in the first slot and their lock waits are not timed.
+ */
+
+/* most an instrumented put/lock may cost over the plain kernel call */
+#define RTSTATS_BUDGET_NS 200
+
+#if defined(CONFIG_SMP)
+#define RTSTATS_SLOT_ALIGN 64
+#else
+#define RTSTATS_SLOT_ALIGN 4
+#endif
+
+struct rtstats_counter {
+	struct {
+		atomic_t value;
+	} __aligned(RTSTATS_SLOT_ALIGN) cpu[CONFIG_MP_MAX_NUM_CPUS];
+};
+
+static inline bool rtstats_user(void)
+{
+	return IS_ENABLED(CONFIG_USERSPACE) && k_is_user_context();
+}
+
+static inline void rtstats_counter_add(struct rtstats_counter *c, atomic_val_t n)
+{
+#if defined(CONFIG_SMP)
+	if (!rtstats_user()) {
+		atomic_add(&c->cpu[arch_curr_cpu()->id].value, n);
+		return;
+	}
+#endif
+	atomic_add(&c->cpu[0].value, n);
+}
+
+uint32_t rtstats_counter_get(const struct rtstats_counter *c);
+
+enum rtstats_kind {
+	RTSTATS_THREAD,
+	RTSTATS_MSGQ,
+	RTSTATS_MUTEX,
+};
+
+struct rtstats_entry {
+	sys_snode_t node;
+	const char *name;
+	enum rtstats_kind kind;
+};
+
+struct rtstats_thread {
+	struct rtstats_entry entry;
+	k_tid_t tid;
+	uint64_t last_cycles;     /* at the previous snapshot */
+};
+
+struct rtstats_msgq {
+	struct rtstats_entry entry;
+	struct k_msgq *msgq;
+	struct rtstats_counter puts;
+	struct rtstats_counter full;      /* puts that failed or timed out */
+	atomic_t max_used;
+};
+
+struct rtstats_mutex {
+	struct rtstats_entry entry;
+	struct k_mutex *mutex;
+	struct rtstats_counter locks;
+	struct rtstats_counter timeouts;
+	/* in us: raw cycles would wrap a 32-bit slot within minutes */
+	struct rtstats_counter wait_us;
+};
+
+void rtstats_register_thread(struct rtstats_thread *t, const char *name,
+			     k_tid_t tid);
+void rtstats_register_msgq(struct rtstats_msgq *q, const char *name,
+			   struct k_msgq *msgq);
+void rtstats_register_mutex(struct rtstats_mutex *m, const char *name,
+			    struct k_mutex *mutex);
+
+/* k_msgq_put() that keeps count; ISR safe with K_NO_WAIT. */
+static inline int rtstats_msgq_put(struct rtstats_msgq *q, const void *data,
+				   k_timeout_t timeout)
+{
+	int ret = k_msgq_put(q->msgq, data, timeout);
+	atomic_val_t used, max;
+
+	if (ret != 0) {
+		rtstats_counter_add(&q->full, 1);
+		return ret;
+	}
+
+	rtstats_counter_add(&q->puts, 1);
+	used = k_msgq_num_used_get(q->msgq);
+	do {
+		max = atomic_get(&q->max_used);
+	} while (used > max && !atomic_cas(&q->max_used, max, used));
+
+	return 0;
+}
+
+/* k_mutex_lock() that counts acquisitions, timeouts and time waited. */
+static inline int rtstats_mutex_lock(struct rtstats_mutex *m, k_timeout_t timeout)
+{
+	bool user = rtstats_user();
+	uint32_t start = user ? 0 : k_cycle_get_32();
+	int ret = k_mutex_lock(m->mutex, timeout);
+
+	if (!user) {
+		rtstats_counter_add(&m->wait_us,
+				    k_cyc_to_us_floor32(k_cycle_get_32() - start));
+	}
+	rtstats_counter_add(ret == 0 ? &m->locks : &m->timeouts, 1);
+
+	return ret;
+}
+
+struct shell;
+
+/* Print a snapshot to the shell, or with printk() when sh is NULL. */
+void rtstats_print(const struct shell *sh);
+
+/* Print a snapshot every period_ms, 0 stops. */
+void rtstats_stream(const struct shell *sh, uint32_t period_ms);
+
+/* Measure the instrumented calls against the plain ones. */
+void rtstats_overhead(const struct shell *sh);
+
+#endif /* RTSTATS_H_ */
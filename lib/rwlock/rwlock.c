@@ -0,0 +1,77 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#include "rwlock.h"
+
+#define RWLOCK_WRITER BIT(30)
+
+void rwlock_init(struct rwlock *rw)
+{
+	atomic_clear(&rw->state);
+	atomic_clear(&rw->writers_waiting);
+	k_mutex_init(&rw->mtx);
+	k_condvar_init(&rw->read_cv);
+	k_condvar_init(&rw->write_cv);
+}
+
+void rwlock_read_lock(struct rwlock *rw)
+{
+	atomic_val_t state;
+
+	/* fast path: nobody writing or queued to write */
+	while (atomic_get(&rw->writers_waiting) == 0) {
+		state = atomic_get(&rw->state);
+		if (state & RWLOCK_WRITER) {
+			break;
+		}
+		if (atomic_cas(&rw->state, state, state + 1)) {
+			return;
+		}
+	}
+
+	/*
+	 * Writers only take the lock with the mutex held, so once we are
+	 * past the loop nothing can race with the increment.
+	 */
+	k_mutex_lock(&rw->mtx, K_FOREVER);
+	while ((atomic_get(&rw->state) & RWLOCK_WRITER) ||
+	       atomic_get(&rw->writers_waiting) != 0) {
+		k_condvar_wait(&rw->read_cv, &rw->mtx, K_FOREVER);
+	}
+	atomic_inc(&rw->state);
+	k_mutex_unlock(&rw->mtx);
+}
+
+void rwlock_read_unlock(struct rwlock *rw)
+{
+	/* last reader out hands over to a queued writer */
+	if (atomic_dec(&rw->state) == 1 &&
+	    atomic_get(&rw->writers_waiting) != 0) {
+		k_mutex_lock(&rw->mtx, K_FOREVER);
+		k_condvar_signal(&rw->write_cv);
+		k_mutex_unlock(&rw->mtx);
+	}
+}
+
+void rwlock_write_lock(struct rwlock *rw)
+{
+	k_mutex_lock(&rw->mtx, K_FOREVER);
+	atomic_inc(&rw->writers_waiting);
+	while (!atomic_cas(&rw->state, 0, RWLOCK_WRITER)) {
+		k_condvar_wait(&rw->write_cv, &rw->mtx, K_FOREVER);
+	}
+	atomic_dec(&rw->writers_waiting);
+	k_mutex_unlock(&rw->mtx);
+}
+
+void rwlock_write_unlock(struct rwlock *rw)
+{
+	k_mutex_lock(&rw->mtx, K_FOREVER);
+	atomic_clear(&rw->state);
+	if (atomic_get(&rw->writers_waiting) != 0) {
+		k_condvar_signal(&rw->write_cv);
+	} else {
+		k_condvar_broadcast(&rw->read_cv);
+	}
+	k_mutex_unlock(&rw->mtx);
+}
@@ -0,0 +1,32 @@
+#ifndef RWLOCK_H_
+#define RWLOCK_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+/*
+ * Writer-preferring reader-writer lock.
+ *
+ * Readers only touch an atomic counter while no writer holds or waits for
+ * the lock. Everything else (a writer getting in, readers queueing behind
+ * a writer) goes through a k_mutex and two condition variables, so waiting
+ * threads sleep instead of spinning. New readers queue as soon as a writer
+ * is waiting, so a steady stream of readers cannot starve the writer.
+ */
+struct rwlock {
+	atomic_t state;           /* reader count, or RWLOCK_WRITER */
+	atomic_t writers_waiting;
+	struct k_mutex mtx;       /* slow path only */
+	struct k_condvar read_cv;
+	struct k_condvar write_cv;
+};
+
+void rwlock_init(struct rwlock *rw);
+
+void rwlock_read_lock(struct rwlock *rw);
+void rwlock_read_unlock(struct rwlock *rw);
+
+void rwlock_write_lock(struct rwlock *rw);
+void rwlock_write_unlock(struct rwlock *rw);
+
+#endif /* RWLOCK_H_ */
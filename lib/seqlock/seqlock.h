@@ -0,0 +1,64 @@
+#ifndef SEQLOCK_H_
+#define SEQLOCK_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/barrier.h>
+
+/*
+ * Sequence lock for small, read-mostly data.
+ *
+ * Readers never block or write shared memory: they copy the data and retry
+ * if a writer was active meanwhile (odd sequence, or sequence changed).
+ * Writers serialize on a spinlock, which also keeps them from being
+ * preempted half-way, so the write side must be short.
+ *
+ *	do {
+ *		seq = seqlock_read_begin(&sl);
+ *		copy = shared;
+ *	} while (seqlock_read_retry(&sl, seq));
+ *
+ * A zero-initialized struct seqlock is ready to use.
+ */
+struct seqlock {
+	atomic_t seq;
+	struct k_spinlock lock;
+};
+
+static inline atomic_val_t seqlock_read_begin(const struct seqlock *sl)
+{
+	atomic_val_t seq;
+
+	/* odd: a writer is in the middle of an update */
+	while ((seq = atomic_get(&sl->seq)) & 1) {
+	}
+	barrier_dmem_fence_full();
+
+	return seq;
+}
+
+static inline bool seqlock_read_retry(const struct seqlock *sl, atomic_val_t seq)
+{
+	barrier_dmem_fence_full();
+
+	return atomic_get(&sl->seq) != seq;
+}
+
+static inline k_spinlock_key_t seqlock_write_begin(struct seqlock *sl)
+{
+	k_spinlock_key_t key = k_spin_lock(&sl->lock);
+
+	atomic_inc(&sl->seq);
+	barrier_dmem_fence_full();
+
+	return key;
+}
+
+static inline void seqlock_write_end(struct seqlock *sl, k_spinlock_key_t key)
+{
+	barrier_dmem_fence_full();
+	atomic_inc(&sl->seq);
+	k_spin_unlock(&sl->lock, key);
+}
+
+#endif /* SEQLOCK_H_ */
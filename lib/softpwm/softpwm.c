@@ -0,0 +1,251 @@
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/printk.h>
+#include <string.h>
+
+#include "softpwm.h"
+
+BUILD_ASSERT(SOFTPWM_STEPS == 64, "the gamma table is computed for 64 steps");
+
+/* round((i / 255)^2.2 * SOFTPWM_STEPS) */
+static const uint8_t gamma[256] = {
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  1,  1,
+	 1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  2,
+	 2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  3,  3,  3,  3,  3,
+	 3,  3,  3,  3,  3,  4,  4,  4,  4,  4,  4,  4,  4,  5,  5,  5,
+	 5,  5,  5,  5,  6,  6,  6,  6,  6,  6,  6,  7,  7,  7,  7,  7,
+	 7,  8,  8,  8,  8,  8,  9,  9,  9,  9,  9,  9, 10, 10, 10, 10,
+	10, 11, 11, 11, 11, 12, 12, 12, 12, 12, 13, 13, 13, 13, 14, 14,
+	14, 14, 15, 15, 15, 15, 16, 16, 16, 16, 17, 17, 17, 17, 18, 18,
+	18, 18, 19, 19, 19, 20, 20, 20, 21, 21, 21, 21, 22, 22, 22, 23,
+	23, 23, 24, 24, 24, 25, 25, 25, 26, 26, 26, 27, 27, 27, 28, 28,
+	28, 29, 29, 29, 30, 30, 30, 31, 31, 32, 32, 32, 33, 33, 34, 34,
+	34, 35, 35, 35, 36, 36, 37, 37, 38, 38, 38, 39, 39, 40, 40, 40,
+	41, 41, 42, 42, 43, 43, 44, 44, 44, 45, 45, 46, 46, 47, 47, 48,
+	48, 49, 49, 50, 50, 51, 51, 51, 52, 52, 53, 53, 54, 54, 55, 55,
+	56, 57, 57, 58, 58, 59, 59, 60, 60, 61, 61, 62, 62, 63, 63, 64,
+};
+
+static struct softpwm_port *port_for(struct softpwm *pwm, const struct device *dev)
+{
+	for (size_t i = 0; i < pwm->n_ports; i++) {
+		if (pwm->ports[i].dev == dev) {
+			return &pwm->ports[i];
+		}
+	}
+	if (pwm->n_ports == SOFTPWM_MAX_PORTS) {
+		return NULL;
+	}
+	pwm->ports[pwm->n_ports].dev = dev;
+	return &pwm->ports[pwm->n_ports++];
+}
+
+int softpwm_init(struct softpwm *pwm, const struct gpio_dt_spec *const leds[],
+		 size_t n)
+{
+	struct softpwm_port *port;
+	int ret;
+
+	if (n > SOFTPWM_MAX_CHANNELS) {
+		return -ENOMEM;
+	}
+
+	memset(pwm->ports, 0, sizeof(pwm->ports));
+	memset(pwm->channels, 0, sizeof(pwm->channels));
+	pwm->n_ports = 0;
+	pwm->n_channels = n;
+	pwm->step = 0;
+	pwm->tick_us = 0;
+	pwm->dirty = false;
+
+	for (size_t i = 0; i < n; i++) {
+		if (!device_is_ready(leds[i]->port)) {
+			return -ENODEV;
+		}
+
+		port = port_for(pwm, leds[i]->port);
+		if (port == NULL) {
+			return -ENOMEM;
+		}
+
+		ret = gpio_pin_configure_dt(leds[i], GPIO_OUTPUT_INACTIVE);
+		if (ret < 0) {
+			return ret;
+		}
+
+		port->mask |= BIT(leds[i]->pin);
+		pwm->channels[i].port = port;
+		pwm->channels[i].bit = BIT(leds[i]->pin);
+	}
+
+	return 0;
+}
+
+/* once per period: move the fades on and rebuild the schedules if needed */
+static void period_start(struct softpwm *pwm)
+{
+	struct softpwm_channel *c;
+	struct softpwm_port *p;
+	uint8_t duty;
+
+	for (size_t i = 0; i < pwm->n_channels; i++) {
+		c = &pwm->channels[i];
+		if (c->periods_left == 0) {
+			continue;
+		}
+		c->level = --c->periods_left ? c->level + c->step : c->target << 8;
+		pwm->dirty = true;
+	}
+
+	if (!pwm->dirty) {
+		return;
+	}
+	pwm->dirty = false;
+
+	for (size_t i = 0; i < pwm->n_ports; i++) {
+		pwm->ports[i].on = 0;
+		memset(pwm->ports[i].off_at, 0, sizeof(pwm->ports[i].off_at));
+	}
+
+	for (size_t i = 0; i < pwm->n_channels; i++) {
+		c = &pwm->channels[i];
+		p = c->port;
+		duty = gamma[c->level >> 8];
+
+		if (duty > 0) {
+			p->on |= c->bit;
+		}
+		if (duty > 0 && duty < SOFTPWM_STEPS) {
+			p->off_at[duty] |= c->bit;
+		}
+	}
+}
+
+static void softpwm_tick(struct k_timer *timer)
+{
+	struct softpwm *pwm = CONTAINER_OF(timer, struct softpwm, timer);
+	uint32_t start = k_cycle_get_32();
+	k_spinlock_key_t key = k_spin_lock(&pwm->lock);
+	struct softpwm_port *p;
+	gpio_port_value_t value;
+	uint32_t cycles;
+
+	if (pwm->step == 0) {
+		period_start(pwm);
+	}
+
+	for (size_t i = 0; i < pwm->n_ports; i++) {
+		p = &pwm->ports[i];
+		value = pwm->step == 0 ? p->on : p->value & ~p->off_at[pwm->step];
+
+		if (value != p->value) {
+			gpio_port_set_masked(p->dev, p->mask, value);
+			p->value = value;
+			pwm->stats.writes++;
+		}
+	}
+
+	pwm->step = (pwm->step + 1) % SOFTPWM_STEPS;
+
+	cycles = k_cycle_get_32() - start;
+	pwm->stats.ticks++;
+	pwm->stats.isr_cycles += cycles;
+	if (cycles > pwm->stats.isr_max) {
+		pwm->stats.isr_max = cycles;
+	}
+
+	k_spin_unlock(&pwm->lock, key);
+}
+
+void softpwm_start(struct softpwm *pwm, uint32_t freq_hz)
+{
+	/* whole ticks, never less than one */
+	uint32_t ticks = MAX(k_us_to_ticks_near32(USEC_PER_SEC /
+						  (freq_hz * SOFTPWM_STEPS)), 1);
+
+	pwm->tick_us = k_ticks_to_us_near32(ticks);
+
+	memset(&pwm->stats, 0, sizeof(pwm->stats));
+	pwm->stats.since = k_uptime_ticks();
+
+	k_timer_init(&pwm->timer, softpwm_tick, NULL);
+	k_timer_start(&pwm->timer, K_TICKS(ticks), K_TICKS(ticks));
+}
+
+void softpwm_stop(struct softpwm *pwm)
+{
+	k_spinlock_key_t key;
+
+	k_timer_stop(&pwm->timer);
+
+	key = k_spin_lock(&pwm->lock);
+	for (size_t i = 0; i < pwm->n_ports; i++) {
+		gpio_port_set_masked(pwm->ports[i].dev, pwm->ports[i].mask, 0);
+		pwm->ports[i].value = 0;
+	}
+	pwm->step = 0;
+	k_spin_unlock(&pwm->lock, key);
+}
+
+void softpwm_set(struct softpwm *pwm, size_t ch, uint8_t brightness)
+{
+	k_spinlock_key_t key = k_spin_lock(&pwm->lock);
+	struct softpwm_channel *c = &pwm->channels[ch];
+
+	c->periods_left = 0;
+	c->target = brightness;
+	c->level = brightness << 8;
+	pwm->dirty = true;
+
+	k_spin_unlock(&pwm->lock, key);
+}
+
+void softpwm_fade(struct softpwm *pwm, size_t ch, uint8_t target, uint32_t ms)
+{
+	uint32_t period_us = pwm->tick_us * SOFTPWM_STEPS;
+	uint32_t periods = period_us ? ms * USEC_PER_MSEC / period_us : 0;
+	k_spinlock_key_t key;
+	struct softpwm_channel *c;
+
+	if (periods == 0) {
+		softpwm_set(pwm, ch, target);
+		return;
+	}
+
+	key = k_spin_lock(&pwm->lock);
+	c = &pwm->channels[ch];
+	c->target = target;
+	c->step = ((int32_t)(target << 8) - c->level) / (int32_t)periods;
+	c->periods_left = periods;
+	k_spin_unlock(&pwm->lock, key);
+}
+
+bool softpwm_fading(struct softpwm *pwm, size_t ch)
+{
+	return pwm->channels[ch].periods_left != 0;
+}
+
+void softpwm_report(struct softpwm *pwm)
+{
+	k_spinlock_key_t key = k_spin_lock(&pwm->lock);
+	struct softpwm_stats s = pwm->stats;
+	int64_t now = k_uptime_ticks();
+	uint64_t window;
+	uint32_t freq, permille;
+
+	memset(&pwm->stats, 0, sizeof(pwm->stats));
+	pwm->stats.since = now;
+	k_spin_unlock(&pwm->lock, key);
+
+	window = k_ticks_to_cyc_floor64(now - s.since);
+	freq = pwm->tick_us ? USEC_PER_SEC / (pwm->tick_us * SOFTPWM_STEPS) : 0;
+	permille = window ? (uint32_t)(s.isr_cycles * 1000 / window) : 0;
+
+	printk("softpwm %u Hz (tick %u us): %u ticks, %u writes, "
+	       "isr avg/max %u/%u ns, cpu %u.%u%%\n",
+	       freq, pwm->tick_us, s.ticks, s.writes,
+	       s.ticks ? (uint32_t)k_cyc_to_ns_floor64(s.isr_cycles / s.ticks) : 0,
+	       (uint32_t)k_cyc_to_ns_floor64(s.isr_max),
+	       permille / 10, permille % 10);
+}
@@ -0,0 +1,95 @@
+#ifndef SOFTPWM_H_
+#define SOFTPWM_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+
+/*
+ * Software PWM for plain GPIO LEDs.
+ *
+ * One k_timer fires SOFTPWM_STEPS times per PWM period. At the start of a
+ * period the handler advances the fades and, if any brightness changed,
+ * rebuilds a per-port schedule from the gamma table: which pins are lit at
+ * step 0 and which ones go dark at each later step. Every other tick only
+ * looks up that schedule and, if the port value changes, writes the whole
+ * port with one gpio_port_set_masked() call, so the cost of a tick does
+ * not grow with the number of LEDs on a port.
+ *
+ * Brightness is 0..255 and goes through a gamma 2.2 table to a duty cycle
+ * of 0..SOFTPWM_STEPS steps. The tick rate is freq_hz * SOFTPWM_STEPS, so
+ * CONFIG_SYS_CLOCK_TICKS_PER_SEC has to be at least that high; the timer
+ * period is rounded to whole ticks and softpwm_report() prints the PWM
+ * frequency actually reached.
+ *
+ * The GPIO driver is called from the timer ISR, so the LEDs must not sit
+ * behind a bus that sleeps (an I2C expander, for instance).
+ */
+
+#define SOFTPWM_STEPS		64
+#define SOFTPWM_MAX_PORTS	2
+#define SOFTPWM_MAX_CHANNELS	8
+
+struct softpwm_port {
+	const struct device *dev;
+	gpio_port_pins_t mask;          /* pins driven by the engine */
+	gpio_port_value_t on;           /* pins lit at step 0 */
+	gpio_port_pins_t off_at[SOFTPWM_STEPS];
+	gpio_port_value_t value;        /* last value written */
+};
+
+struct softpwm_channel {
+	struct softpwm_port *port;
+	gpio_port_pins_t bit;
+	int32_t level;          /* brightness in 8.8 fixed point */
+	int32_t step;           /* added to level every period while fading */
+	uint32_t periods_left;
+	uint8_t target;
+};
+
+struct softpwm_stats {
+	uint32_t ticks;
+	uint32_t writes;        /* gpio_port_set_masked() calls */
+	uint64_t isr_cycles;
+	uint32_t isr_max;
+	int64_t since;          /* uptime ticks at the last report */
+};
+
+struct softpwm {
+	struct k_timer timer;
+	struct k_spinlock lock;
+	struct softpwm_port ports[SOFTPWM_MAX_PORTS];
+	size_t n_ports;
+	struct softpwm_channel channels[SOFTPWM_MAX_CHANNELS];
+	size_t n_channels;
+	uint32_t step;
+	uint32_t tick_us;       /* timer period actually used */
+	bool dirty;
+	struct softpwm_stats stats;
+};
+
+/*
+ * Configure the LEDs as outputs, off, and group them by port. Channel i is
+ * leds[i]. Returns -ENODEV if a port is not ready, -ENOMEM if there are
+ * more LEDs or ports than the engine has room for.
+ */
+int softpwm_init(struct softpwm *pwm, const struct gpio_dt_spec *const leds[],
+		 size_t n);
+
+void softpwm_start(struct softpwm *pwm, uint32_t freq_hz);
+void softpwm_stop(struct softpwm *pwm);
+
+/* Set a channel's brightness now, cancelling any fade on it. */
+void softpwm_set(struct softpwm *pwm, size_t ch, uint8_t brightness);
+
+/* Move a channel's brightness linearly to `target` over `ms`. */
+void softpwm_fade(struct softpwm *pwm, size_t ch, uint8_t target, uint32_t ms);
+
+bool softpwm_fading(struct softpwm *pwm, size_t ch);
+
+/*
+ * Print the PWM frequency, the handler cost per tick (avg/max) and the
+ * share of the CPU spent in it since the last report, then reset.
+ */
+void softpwm_report(struct softpwm *pwm);
+
+#endif /* SOFTPWM_H_ */
@@ -0,0 +1,79 @@
+#ifndef SPSC_RING_H_
+#define SPSC_RING_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+/*
+ * Lock-free single-producer / single-consumer ring of fixed-size slots.
+ *
+ * Meant for an ISR handing work to one thread: neither side takes a lock
+ * or disables interrupts. The producer fills a slot in place and then
+ * publishes it, the consumer reads a slot in place and then releases it,
+ * so nothing is copied twice. publish returns how many slots were already
+ * queued, so the producer can wake the consumer on the empty -> non-empty
+ * transition only.
+ *
+ * Slot count must be a power of two.
+ */
+struct spsc_ring {
+	atomic_t head;      /* next slot the producer publishes */
+	atomic_t tail;      /* next slot the consumer reads */
+	uint8_t *buf;
+	size_t slot_size;
+	uint32_t mask;
+};
+
+#define SPSC_RING_DEFINE(_name, _slot_size, _slots)			  \
+	BUILD_ASSERT(((_slots) & ((_slots) - 1)) == 0,			  \
+		     "slot count must be a power of two");		  \
+	static uint8_t _name##_buf[(_slots) * (_slot_size)] __aligned(4); \
+	struct spsc_ring _name = {					  \
+		.buf = _name##_buf,					  \
+		.slot_size = (_slot_size),				  \
+		.mask = (_slots) - 1,					  \
+	}
+
+static inline uint32_t spsc_ring_used(const struct spsc_ring *r)
+{
+	return (uint32_t)(atomic_get(&r->head) - atomic_get(&r->tail));
+}
+
+/* Producer: slot to fill next, or NULL when the ring is full. */
+static inline void *spsc_ring_claim(struct spsc_ring *r)
+{
+	atomic_val_t head = atomic_get(&r->head);
+
+	if ((uint32_t)(head - atomic_get(&r->tail)) > r->mask) {
+		return NULL;
+	}
+	return r->buf + (head & r->mask) * r->slot_size;
+}
+
+/* Producer: make the claimed slot visible. Returns slots queued before. */
+static inline uint32_t spsc_ring_publish(struct spsc_ring *r)
+{
+	/* atomic_inc is a full barrier: the slot is written before it shows */
+	atomic_val_t head = atomic_inc(&r->head);
+
+	return (uint32_t)(head - atomic_get(&r->tail));
+}
+
+/* Consumer: oldest published slot, or NULL when the ring is empty. */
+static inline void *spsc_ring_peek(struct spsc_ring *r)
+{
+	atomic_val_t tail = atomic_get(&r->tail);
+
+	if (tail == atomic_get(&r->head)) {
+		return NULL;
+	}
+	return r->buf + (tail & r->mask) * r->slot_size;
+}
+
+/* Consumer: hand the peeked slot back to the producer. */
+static inline void spsc_ring_release(struct spsc_ring *r)
+{
+	atomic_inc(&r->tail);
+}
+
+#endif /* SPSC_RING_H_ */
@@ -0,0 +1,28 @@
+#include <zephyr/kernel.h>
+#include <zephyr/app_memory/app_memdomain.h>
+#include <zephyr/sys/libc-hooks.h>
+
+#include "usermode.h"
+
+K_APPMEM_PARTITION_DEFINE(usermode_part);
+
+static struct k_mem_domain usermode_domain;
+
+void usermode_start(const k_tid_t threads[], size_t n)
+{
+	struct k_mem_partition *parts[] = {
+		&usermode_part,
+#if Z_LIBC_PARTITION_EXISTS
+		&z_libc_partition,
+#endif
+	};
+
+	k_mem_domain_init(&usermode_domain, ARRAY_SIZE(parts), parts);
+
+	for (size_t i = 0; i < n; i++) {
+		k_mem_domain_add_thread(&usermode_domain, threads[i]);
+	}
+	for (size_t i = 0; i < n; i++) {
+		k_thread_start(threads[i]);
+	}
+}
@@ -0,0 +1,42 @@
+#ifndef USERMODE_H_
+#define USERMODE_H_
+
+#include <zephyr/kernel.h>
+
+/*
+ * Userspace build support.
+ *
+ * With CONFIG_USERSPACE the app threads are created with
+ * USERMODE_OPTIONS (K_USER) and unstarted. main() then hands them to
+ * usermode_start(), which puts them in one memory domain and starts them.
+ * The domain holds usermode_part (plus the libc partition when there is
+ * one). Data the threads write goes into that partition with
+ * USERMODE_DATA / USERMODE_BSS. Kernel objects they use still have to be
+ * granted, e.g. with K_THREAD_ACCESS_GRANT().
+ *
+ * Without CONFIG_USERSPACE the macros expand to nothing and the threads
+ * run in supervisor mode as before.
+ */
+
+#if defined(CONFIG_USERSPACE)
+
+#include <zephyr/app_memory/app_memdomain.h>
+
+extern struct k_mem_partition usermode_part;
+
+#define USERMODE_OPTIONS	K_USER
+#define USERMODE_DATA		K_APP_DMEM(usermode_part)
+#define USERMODE_BSS		K_APP_BMEM(usermode_part)
+
+/* Add the threads to the app memory domain, then start them. */
+void usermode_start(const k_tid_t threads[], size_t n);
+
+#else
+
+#define USERMODE_OPTIONS	0
+#define USERMODE_DATA
+#define USERMODE_BSS
+
+#endif /* CONFIG_USERSPACE */
+
+#endif /* USERMODE_H_ */
@@ -7,9 +7,15 @@
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/gpio.h>
 
+#include "bootprof.h"
+#include "periodic.h"
+
 /* 1000 msec = 1 sec */
 #define SLEEP_TIME_MS   100
 
+/* print the scheduling report every 10 s */
+#define REPORT_EVERY    (10000 / SLEEP_TIME_MS)
+
 /* The devicetree node identifier for the "led0" alias. */
 #define LED0_NODE DT_ALIAS(led0)
 #define LED1_NODE DT_ALIAS(led1)
@@ -25,29 +31,33 @@ static const struct gpio_dt_spec led1 = GPIO_DT_SPEC_GET(LED1_NODE, gpios);
 static const struct gpio_dt_spec led2 = GPIO_DT_SPEC_GET(LED2_NODE, gpios);
 static const struct gpio_dt_spec led3 = GPIO_DT_SPEC_GET(LED3_NODE, gpios);
 
+static const struct gpio_dt_spec *const leds[] = { &led0, &led1, &led2, &led3 };
+
+static PERIODIC_TASK_DEFINE(led_chase, SLEEP_TIME_MS, 0, 0);
+
 void main(void)
 {
 	int ret, iterator = 0;
 
-	if (!device_is_ready(led0.port) || !device_is_ready(led1.port) || !device_is_ready(led2.port) || !device_is_ready(led3.port)) {
-		return;
-	}
-
-	ret = gpio_pin_configure_dt(&led0, GPIO_OUTPUT_ACTIVE);
-	if (ret < 0) return;
+	bootprof_mark(BOOTPROF_MAIN);
 
-	ret = gpio_pin_configure_dt(&led1, GPIO_OUTPUT_ACTIVE);
-	if (ret < 0) return;
-
-	ret = gpio_pin_configure_dt(&led2, GPIO_OUTPUT_ACTIVE);
-	if (ret < 0) return;
-
-	ret = gpio_pin_configure_dt(&led3, GPIO_OUTPUT_ACTIVE);
-	if (ret < 0) return;
+	for (int i = 0; i < ARRAY_SIZE(leds); i++) {
+		/* the LEDs usually share one port, check each port once */
+		if ((i == 0 || leds[i]->port != leds[i - 1]->port) &&
+		    !device_is_ready(leds[i]->port)) {
+			return;
+		}
 
+		ret = gpio_pin_configure_dt(leds[i], GPIO_OUTPUT_ACTIVE);
+		if (ret < 0) return;
+		bootprof_mark(BOOTPROF_FIRST_GPIO);
+	}
+	bootprof_report();
 
 	// gpio_dt_spec arr[4] = {&led0, &led1, &led2, &led3}
 
+	periodic_task_start(&led_chase);
+
 	while (1) {
 		
 		switch(iterator++ % 4)
@@ -68,6 +78,9 @@ void main(void)
 				break;
 		}
 		// ret0 = gpio_pin_toggle_dt(arr[(iterator++) % 4]);
-		k_msleep(SLEEP_TIME_MS);
+		if (iterator % REPORT_EVERY == 0) {
+			periodic_task_report(&led_chase);
+		}
+		periodic_task_wait(&led_chase);
 	}
 }
@@ -12,9 +12,19 @@
 #include <zephyr/sys/printk.h>
 #include <inttypes.h>
 
+#include "bootprof.h"
+#include "debounce.h"
+#include "periodic.h"
+
 #define SLEEP_TIME_MS	200
 #define DEBOUNCE_TIME_MS 10
 
+/* the button is sampled every poll period, the chase steps every CHASE_TIME_MS */
+#define POLL_TIME_MS	DEBOUNCE_TIME_MS
+#define CHASE_TIME_MS	100
+#define CHASE_EVERY	(CHASE_TIME_MS / POLL_TIME_MS)
+#define REPORT_EVERY	(10000 / POLL_TIME_MS)
+
 /*
  * Get button configuration from the devicetree sw0 alias. This is mandatory.
  */
@@ -35,6 +45,10 @@ static struct gpio_dt_spec led1 = GPIO_DT_SPEC_GET_OR(DT_ALIAS(led1), gpios, {0}
 static struct gpio_dt_spec led2 = GPIO_DT_SPEC_GET_OR(DT_ALIAS(led2), gpios, {0});
 static struct gpio_dt_spec led3 = GPIO_DT_SPEC_GET_OR(DT_ALIAS(led3), gpios, {0});
 
+static const struct gpio_dt_spec *const leds[] = { &led0, &led1, &led2, &led3 };
+
+static PERIODIC_TASK_DEFINE(button_poll, POLL_TIME_MS, 0, 0);
+
 void button_pressed(const struct device *dev, struct gpio_callback *cb, uint32_t pins)
 {
 	printk("Button pressed at %" PRIu32 "\n", k_cycle_get_32());
@@ -63,21 +77,20 @@ void main(void)
 {
 	int ret;
 
-	if (!device_is_ready(led0.port) || !device_is_ready(led1.port) || !device_is_ready(led2.port) || !device_is_ready(led3.port)) {
-		return;
-	}
-	
-	ret = gpio_pin_configure_dt(&led0, GPIO_OUTPUT_LOW);
-	if (ret < 0) return;
-
-	ret = gpio_pin_configure_dt(&led1, GPIO_OUTPUT_LOW);
-	if (ret < 0) return;
+	bootprof_mark(BOOTPROF_MAIN);
 
-	ret = gpio_pin_configure_dt(&led2, GPIO_OUTPUT_LOW);
-	if (ret < 0) return;
+	for (int i = 0; i < ARRAY_SIZE(leds); i++) {
+		/* the LEDs usually share one port, check each port once */
+		if ((i == 0 || leds[i]->port != leds[i - 1]->port) &&
+		    !device_is_ready(leds[i]->port)) {
+			return;
+		}
 
-	ret = gpio_pin_configure_dt(&led3, GPIO_OUTPUT_LOW);
-	if (ret < 0) return;
+		/* configuring as GPIO_OUTPUT_LOW already drives them off */
+		ret = gpio_pin_configure_dt(leds[i], GPIO_OUTPUT_LOW);
+		if (ret < 0) return;
+		bootprof_mark(BOOTPROF_FIRST_GPIO);
+	}
 
 	if (!device_is_ready(button.port)) {
 		printk("Error: button device %s is not ready\n",
@@ -85,12 +98,6 @@ void main(void)
 		return;
 	}
 
-	
-	gpio_pin_set_dt(&led0, 0);
-	gpio_pin_set_dt(&led1, 0);
-	gpio_pin_set_dt(&led2, 0);
-	gpio_pin_set_dt(&led3, 0);
-
 	ret = gpio_pin_configure_dt(&button, GPIO_INPUT);
 
 	if (ret != 0) {
@@ -127,19 +134,26 @@ void main(void)
 	// }
 
 
+	bootprof_mark(BOOTPROF_FIRST_UART);
 	printk("Press the button\n");
+	bootprof_report();
 
 	bool party_on = false;
 
-	bool button_last_state = 0;
+	struct debounce button_debounce = {0};
 
 	short iterator = 0;
+	uint32_t job = 0;
+
+	periodic_task_start(&button_poll);
+
 	while (1) {
 		/* If we have an LED, match its state to the button's. */
 		bool button_state = is_pressed();
-		bool button1 = gpio_pin_get_dt(&button1) == 0;
 
-		if (party_on)
+		job++;
+
+		if (party_on && job % CHASE_EVERY == 0)
 		{
 			iterator = (iterator + 1) % 4;
 			switch(iterator)
@@ -159,9 +173,8 @@ void main(void)
 				default:
 					break;
 			}
-			k_sleep(K_MSEC(100));
 		}
-		else
+		else if (!party_on)
 		{
 			gpio_pin_set_dt(&led0, 0);
 			gpio_pin_set_dt(&led1, 0);
@@ -169,16 +182,20 @@ void main(void)
 			gpio_pin_set_dt(&led3, 0);
 		}
 
-		if (button_state && button_state != button_last_state) {
-			//DEBOUNCE
-			k_msleep(DEBOUNCE_TIME_MS);
-			if(is_pressed())
-			{
-				// toggle(); //toggle led0
-				toggle_led_party(&party_on);
-			}
+		/*
+		 * DEBOUNCE: an edge is only accepted if the button is still
+		 * pressed on the next sample, one poll period (DEBOUNCE_TIME_MS)
+		 * later.
+		 */
+		if (debounce_sample(&button_debounce, button_state))
+		{
+			// toggle(); //toggle led0
+			toggle_led_party(&party_on);
 		}
-		button_last_state = button_state;
 
+		if (job % REPORT_EVERY == 0) {
+			periodic_task_report(&button_poll);
+		}
+		periodic_task_wait(&button_poll);
 	}
 }
@@ -7,19 +7,25 @@
  */
 
 #include <zephyr/kernel.h>
+#include <zephyr/init.h>
 #include <zephyr/sys/printk.h>
 #include <zephyr/drivers/gpio.h>
 #include <string.h>
 
+#include "bootprof.h"
+#include "periodic.h"
+#include "rtstats.h"
+#include "usermode.h"
+
 
 #define LED0_NODE DT_ALIAS(led0)
 #define LED1_NODE DT_ALIAS(led1)
 
 /*
  * The hello world demo has two threads that utilize semaphores and sleeping
- * to take turns printing a greeting message at a controlled rate. The demo
- * shows both the static and dynamic approaches for spawning a thread; a real
- * world application would likely use the static approach for both threads.
+ * to take turns printing a greeting message at a controlled rate. Both
+ * threads are static: the kernel builds them at boot and they wait on their
+ * queues until main() hands over the first message.
  */
 
 #define PIN_THREADS (IS_ENABLED(CONFIG_SMP)		  \
@@ -32,9 +38,27 @@
 /* scheduling priority used by each thread */
 #define PRIORITY 7
 
+/* user threads are started by main() once they are in the app memory domain */
+#if defined(CONFIG_USERSPACE)
+#define START_DELAY SYS_FOREVER_MS
+#else
+#define START_DELAY 0
+#endif
+
 /* delay between greetings (in ms) */
 #define SLEEPTIME 500
 
+/*
+ * Each thread holds the message for one RELAY_MS slot before passing it on,
+ * so a full A -> B -> A round takes 2 * RELAY_MS. thread_b is released in
+ * the second half of the round.
+ */
+#define RELAY_MS 1000
+#define ROUND_MS (2 * RELAY_MS)
+
+/* print the scheduling report every 10 rounds */
+#define REPORT_EVERY 10
+
 //create leds
 static struct gpio_dt_spec led0 = GPIO_DT_SPEC_GET_OR(DT_ALIAS(led0), gpios, {0});
 static struct gpio_dt_spec led1 = GPIO_DT_SPEC_GET_OR(DT_ALIAS(led1), gpios, {0});
@@ -48,73 +72,106 @@ struct data_item_type {
 K_MSGQ_DEFINE(my_msgqA, sizeof(struct data_item_type), 10, 4);
 K_MSGQ_DEFINE(my_msgqB, sizeof(struct data_item_type), 10, 4);
 
-K_THREAD_STACK_DEFINE(threadA_stack_area, STACKSIZE);
-static struct k_thread threadA_data;
+/* shown by the "rtstats" shell command */
+static USERMODE_BSS struct rtstats_msgq my_msgqA_stats;
+static USERMODE_BSS struct rtstats_msgq my_msgqB_stats;
+static struct rtstats_thread threadA_stats;
+static struct rtstats_thread threadB_stats;
 
-K_THREAD_STACK_DEFINE(threadB_stack_area, STACKSIZE);
-static struct k_thread threadB_data;
+static USERMODE_DATA PERIODIC_TASK_DEFINE(threadA_task, ROUND_MS, RELAY_MS, 0);
+static USERMODE_DATA PERIODIC_TASK_DEFINE(threadB_task, ROUND_MS, RELAY_MS, RELAY_MS);
 
 /* threadA is a static thread that is spawned automatically */
 
 void threadA(void *dummy1, void *dummy2, void *dummy3)
 {
     struct data_item_type data;
+
+    bootprof_mark(BOOTPROF_FIRST_THREAD);
+    periodic_task_start(&threadA_task);
     while(1)
     {
         //get the item data
         k_msgq_get(&my_msgqA, &data, K_FOREVER);
-        k_msleep(1000);
 
         //process data
+        bootprof_mark(BOOTPROF_FIRST_UART);
         printk("%s: message received with content\n", "Thread A");
+        bootprof_report();
+
+        rtstats_msgq_put(&my_msgqB_stats, &data, K_NO_WAIT);
 
-        k_msgq_put(&my_msgqB, &data, K_NO_WAIT);
+        if (threadA_task.stats.jobs % REPORT_EVERY == 0) {
+            periodic_task_report(&threadA_task);
+        }
+        periodic_task_wait(&threadA_task);
     }
 
 }
 
+K_THREAD_DEFINE(thread_a, STACKSIZE, threadA, NULL, NULL, NULL,
+                PRIORITY, USERMODE_OPTIONS, START_DELAY);
+K_THREAD_ACCESS_GRANT(thread_a, &my_msgqA, &my_msgqB);
+
 void threadB(void *dummy1, void *dummy2, void *dummy3)
 {
-    uint8_t data;
+    struct data_item_type data;
+
+    bootprof_mark(BOOTPROF_FIRST_THREAD);
+    periodic_task_start(&threadB_task);
     while(1)
     {
         //get the item data
         k_msgq_get(&my_msgqB, &data, K_FOREVER);
 
-        k_msleep(1000);
         //process data
+        bootprof_mark(BOOTPROF_FIRST_UART);
         printk("%s: message received with content\n", "Thread B");
-        k_msgq_put(&my_msgqA, &data, K_NO_WAIT);
+        bootprof_report();
+        rtstats_msgq_put(&my_msgqA_stats, &data, K_NO_WAIT);
+
+        if (threadB_task.stats.jobs % REPORT_EVERY == 0) {
+            periodic_task_report(&threadB_task);
+        }
+        periodic_task_wait(&threadB_task);
     }
 }
 
+K_THREAD_DEFINE(thread_b, STACKSIZE, threadB, NULL, NULL, NULL,
+                PRIORITY, USERMODE_OPTIONS, START_DELAY);
+K_THREAD_ACCESS_GRANT(thread_b, &my_msgqA, &my_msgqB);
+
+/* runs before the static threads start, so they never use an unregistered queue */
+static int register_stats(void)
+{
+    rtstats_register_msgq(&my_msgqA_stats, "my_msgqA", &my_msgqA);
+    rtstats_register_msgq(&my_msgqB_stats, "my_msgqB", &my_msgqB);
+    rtstats_register_thread(&threadA_stats, "thread_a", thread_a);
+    rtstats_register_thread(&threadB_stats, "thread_b", thread_b);
+    return 0;
+}
+
+SYS_INIT(register_stats, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+
 void main(void)
 {
     struct data_item_type data;
 
+    bootprof_mark(BOOTPROF_MAIN);
     data.field1 = 1;
 
 
     // configure leds
     gpio_pin_configure_dt(&led0, GPIO_OUTPUT_ACTIVE);
+    bootprof_mark(BOOTPROF_FIRST_GPIO);
     gpio_pin_configure_dt(&led1, GPIO_OUTPUT_ACTIVE);
 
-    k_thread_create(&threadA_data, threadA_stack_area,
-                    K_THREAD_STACK_SIZEOF(threadA_stack_area),
-                    threadA, NULL, NULL, NULL,
-                    PRIORITY, 0, K_FOREVER);
-    k_thread_name_set(&threadA_data, "thread_a");
-
-    k_thread_create(&threadB_data, threadB_stack_area,
-                    K_THREAD_STACK_SIZEOF(threadB_stack_area),
-                    threadB, NULL, NULL, NULL,
-                    PRIORITY, 0, K_FOREVER);
-    k_thread_name_set(&threadB_data, "thread_b");
-
-    k_thread_start(&threadA_data);
-    k_thread_start(&threadB_data);
+#if defined(CONFIG_USERSPACE)
+    usermode_start((const k_tid_t[]){ thread_a, thread_b }, 2);
+#endif
 
-    k_msgq_put(&my_msgqB, &data, K_NO_WAIT);
+    /* the threads are waiting on their queues */
+    rtstats_msgq_put(&my_msgqB_stats, &data, K_NO_WAIT);
 
     while (1){
         k_msleep(100);
@@ -0,0 +1,385 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/atomic.h>
+#include <string.h>
+
+#include "workloads.h"
+
+/*
+ * Bounded buffer workload: CONFIG_APP_PRODUCERS producers and
+ * CONFIG_APP_CONSUMERS consumers share a ring of CONFIG_APP_BUFFER_SIZE
+ * items. Making or using an item costs a fixed busy time outside the lock.
+ * The same workload runs with three ways of waiting for room or items:
+ *
+ *   timed retry - the counter workload's old pattern: k_mutex_lock() with
+ *                 a timeout, retried forever, and the lock held across a
+ *                 sleep when the buffer is not ready
+ *   k_condvar   - wait on "not full" / "not empty" under the mutex
+ *   k_sem       - one semaphore counts free slots, one counts items
+ *
+ * A wakeup is a return from a wait for room or items: k_condvar_wait(), a
+ * k_sem_take() that blocked, or the timed retry's sleep. It is spurious
+ * when, with buf_mx held again, there is still no room or no item. Time
+ * blocked on buf_mx itself is mutex contention and counted apart, with
+ * the timed retry's lock timeouts.
+ */
+
+#define STACK_SIZE 1024
+#define PRIORITY 7
+
+#define PRODUCE_US 50
+#define CONSUME_US 50
+
+/* the counter workload used 1000 ms and 2000 ms, scaled down */
+#define RETRY_SLEEP_MS 1
+#define RETRY_TIMEOUT_MS 2
+
+enum wait_kind {
+    WAIT_TIMED_RETRY,
+    WAIT_CONDVAR,
+    WAIT_SEM,
+    WAIT_KINDS,
+};
+
+static const char *const wait_names[WAIT_KINDS] = {
+    [WAIT_TIMED_RETRY] = "timed retry",
+    [WAIT_CONDVAR] = "k_condvar",
+    [WAIT_SEM] = "k_sem",
+};
+
+/* one cache line each so the threads do not share counters */
+struct bb_stats {
+    uint32_t items;
+    uint32_t wakeups;       /* returns from a wait for room or items */
+    uint32_t spurious;      /* ... after which there still was none */
+    uint32_t lock_waits;    /* blocked on buf_mx itself */
+    uint32_t timeouts;      /* ... and gave up */
+} __aligned(64);
+
+static struct {
+    uint32_t slots[CONFIG_APP_BUFFER_SIZE];
+    uint32_t head;
+    uint32_t count;
+} buf;
+
+static enum wait_kind kind;
+static atomic_t running;
+
+static struct k_mutex buf_mx;
+static struct k_condvar not_full;
+static struct k_condvar not_empty;
+static struct k_sem free_slots;
+static struct k_sem used_slots;
+
+static struct bb_stats producer_stats[CONFIG_APP_PRODUCERS];
+static struct bb_stats consumer_stats[CONFIG_APP_CONSUMERS];
+
+K_THREAD_STACK_ARRAY_DEFINE(producer_stacks, CONFIG_APP_PRODUCERS, STACK_SIZE);
+K_THREAD_STACK_ARRAY_DEFINE(consumer_stacks, CONFIG_APP_CONSUMERS, STACK_SIZE);
+static struct k_thread producers[CONFIG_APP_PRODUCERS];
+static struct k_thread consumers[CONFIG_APP_CONSUMERS];
+
+/* the wait predicates, only meaningful with buf_mx held */
+static bool buf_full(void) {
+    return buf.count == CONFIG_APP_BUFFER_SIZE;
+}
+
+static bool buf_empty(void) {
+    return buf.count == 0;
+}
+
+/*
+ * k_mutex_lock() that counts contention apart from the wakeups: blocking on
+ * the mutex is not waiting for room or items.
+ */
+static int lock(struct bb_stats *st, k_timeout_t timeout) {
+    int ret;
+
+    if (k_mutex_lock(&buf_mx, K_NO_WAIT) == 0) {
+        return 0;
+    }
+
+    st->lock_waits++;
+    ret = k_mutex_lock(&buf_mx, timeout);
+    if (ret != 0) {
+        st->timeouts++;
+    }
+    return ret;
+}
+
+/* returns with buf_mx held; spurious if `pred` still holds then */
+static void cond_wait(struct bb_stats *st, struct k_condvar *cv,
+                      bool (*pred)(void)) {
+    k_condvar_wait(cv, &buf_mx, K_FOREVER);
+    st->wakeups++;
+    if (pred() && atomic_get(&running)) {
+        st->spurious++;
+    }
+}
+
+/* returns true if the thread had to wait */
+static bool sem_take(struct bb_stats *st, struct k_sem *sem) {
+    if (k_sem_take(sem, K_NO_WAIT) == 0) {
+        return false;
+    }
+
+    k_sem_take(sem, K_FOREVER);
+    st->wakeups++;
+    return true;
+}
+
+/* timed retry: sleep with buf_mx held, as the counter workload did */
+static void retry_sleep(struct bb_stats *st, bool (*pred)(void)) {
+    k_msleep(RETRY_SLEEP_MS);
+    st->wakeups++;
+    /* always true: nobody can change the buffer while we hold the lock */
+    if (pred()) {
+        st->spurious++;
+    }
+}
+
+static void buf_put(uint32_t item) {
+    buf.slots[(buf.head + buf.count) % CONFIG_APP_BUFFER_SIZE] = item;
+    buf.count++;
+}
+
+static uint32_t buf_get(void) {
+    uint32_t item = buf.slots[buf.head];
+
+    buf.head = (buf.head + 1) % CONFIG_APP_BUFFER_SIZE;
+    buf.count--;
+    return item;
+}
+
+/* returns false if the run ended before the item went in */
+static bool put(struct bb_stats *st, uint32_t item) {
+    bool waited;
+
+    switch (kind) {
+    case WAIT_TIMED_RETRY:
+        while (atomic_get(&running)) {
+            if (lock(st, K_MSEC(RETRY_TIMEOUT_MS)) != 0) {
+                continue;
+            }
+            if (!buf_full()) {
+                buf_put(item);
+                k_mutex_unlock(&buf_mx);
+                return true;
+            }
+            retry_sleep(st, buf_full);
+            k_mutex_unlock(&buf_mx);
+        }
+        return false;
+    case WAIT_CONDVAR:
+        lock(st, K_FOREVER);
+        while (buf_full() && atomic_get(&running)) {
+            cond_wait(st, &not_full, buf_full);
+        }
+        if (!atomic_get(&running)) {
+            k_mutex_unlock(&buf_mx);
+            return false;
+        }
+        buf_put(item);
+        k_condvar_signal(&not_empty);
+        k_mutex_unlock(&buf_mx);
+        return true;
+    case WAIT_SEM:
+        waited = sem_take(st, &free_slots);
+        if (!atomic_get(&running)) {
+            return false;
+        }
+        lock(st, K_FOREVER);
+        /* the slot count makes this impossible, checked all the same */
+        if (waited && buf_full()) {
+            st->spurious++;
+        }
+        buf_put(item);
+        k_mutex_unlock(&buf_mx);
+        k_sem_give(&used_slots);
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* returns false if the run ended before an item came out */
+static bool get(struct bb_stats *st, uint32_t *item) {
+    bool waited;
+
+    switch (kind) {
+    case WAIT_TIMED_RETRY:
+        while (atomic_get(&running)) {
+            if (lock(st, K_MSEC(RETRY_TIMEOUT_MS)) != 0) {
+                continue;
+            }
+            if (!buf_empty()) {
+                *item = buf_get();
+                k_mutex_unlock(&buf_mx);
+                return true;
+            }
+            retry_sleep(st, buf_empty);
+            k_mutex_unlock(&buf_mx);
+        }
+        return false;
+    case WAIT_CONDVAR:
+        lock(st, K_FOREVER);
+        while (buf_empty() && atomic_get(&running)) {
+            cond_wait(st, &not_empty, buf_empty);
+        }
+        if (!atomic_get(&running)) {
+            k_mutex_unlock(&buf_mx);
+            return false;
+        }
+        *item = buf_get();
+        k_condvar_signal(&not_full);
+        k_mutex_unlock(&buf_mx);
+        return true;
+    case WAIT_SEM:
+        waited = sem_take(st, &used_slots);
+        if (!atomic_get(&running)) {
+            return false;
+        }
+        lock(st, K_FOREVER);
+        if (waited && buf_empty()) {
+            st->spurious++;
+        }
+        *item = buf_get();
+        k_mutex_unlock(&buf_mx);
+        k_sem_give(&free_slots);
+        return true;
+    default:
+        return false;
+    }
+}
+
+void producer_entry(void *stats_ptr, void *nothing_1, void *nothing_2) {
+    struct bb_stats *st = stats_ptr;
+    uint32_t item = 0;
+
+    while (atomic_get(&running)) {
+        k_busy_wait(PRODUCE_US);
+        if (put(st, item++)) {
+            st->items++;
+        }
+    }
+}
+
+void consumer_entry(void *stats_ptr, void *nothing_1, void *nothing_2) {
+    struct bb_stats *st = stats_ptr;
+    uint32_t item;
+
+    while (atomic_get(&running)) {
+        if (get(st, &item)) {
+            st->items++;
+            k_busy_wait(CONSUME_US);
+        }
+    }
+}
+
+/* wake everyone still waiting for room or items so they see the end */
+static void stop(void) {
+    atomic_set(&running, 0);
+
+    switch (kind) {
+    case WAIT_CONDVAR:
+        k_mutex_lock(&buf_mx, K_FOREVER);
+        k_condvar_broadcast(&not_full);
+        k_condvar_broadcast(&not_empty);
+        k_mutex_unlock(&buf_mx);
+        break;
+    case WAIT_SEM:
+        for (int i = 0; i < CONFIG_APP_PRODUCERS; i++) {
+            k_sem_give(&free_slots);
+        }
+        for (int i = 0; i < CONFIG_APP_CONSUMERS; i++) {
+            k_sem_give(&used_slots);
+        }
+        break;
+    default:
+        /* timed retry threads time out on their own */
+        break;
+    }
+}
+
+static void sum_stats(const struct bb_stats *stats, int n, struct bb_stats *sum) {
+    for (int i = 0; i < n; i++) {
+        sum->items += stats[i].items;
+        sum->wakeups += stats[i].wakeups;
+        sum->spurious += stats[i].spurious;
+        sum->lock_waits += stats[i].lock_waits;
+        sum->timeouts += stats[i].timeouts;
+    }
+}
+
+static void run_case(enum wait_kind wait) {
+    struct bb_stats put_sum = { 0 }, get_sum = { 0 };
+    uint32_t wakeups, per_item;
+
+    kind = wait;
+    memset(&buf, 0, sizeof(buf));
+    memset(producer_stats, 0, sizeof(producer_stats));
+    memset(consumer_stats, 0, sizeof(consumer_stats));
+    k_sem_init(&free_slots, CONFIG_APP_BUFFER_SIZE, CONFIG_APP_BUFFER_SIZE);
+    k_sem_init(&used_slots, 0, CONFIG_APP_BUFFER_SIZE);
+    atomic_set(&running, 1);
+
+    for (int i = 0; i < CONFIG_APP_CONSUMERS; i++) {
+        k_thread_create(&consumers[i], consumer_stacks[i],
+                        K_THREAD_STACK_SIZEOF(consumer_stacks[i]),
+                        consumer_entry, &consumer_stats[i], NULL, NULL,
+                        PRIORITY, 0, K_NO_WAIT);
+    }
+    for (int i = 0; i < CONFIG_APP_PRODUCERS; i++) {
+        k_thread_create(&producers[i], producer_stacks[i],
+                        K_THREAD_STACK_SIZEOF(producer_stacks[i]),
+                        producer_entry, &producer_stats[i], NULL, NULL,
+                        PRIORITY, 0, K_NO_WAIT);
+    }
+
+    k_msleep(CONFIG_APP_RUN_MS);
+    stop();
+
+    for (int i = 0; i < CONFIG_APP_PRODUCERS; i++) {
+        k_thread_join(&producers[i], K_FOREVER);
+    }
+    for (int i = 0; i < CONFIG_APP_CONSUMERS; i++) {
+        k_thread_join(&consumers[i], K_FOREVER);
+    }
+
+    sum_stats(producer_stats, CONFIG_APP_PRODUCERS, &put_sum);
+    sum_stats(consumer_stats, CONFIG_APP_CONSUMERS, &get_sum);
+
+    wakeups = put_sum.wakeups + get_sum.wakeups;
+    /* in hundredths */
+    per_item = get_sum.items ?
+               (uint32_t)((uint64_t)wakeups * 100 / get_sum.items) : 0;
+
+    printk("%-11s %6u items/s, %u.%02u wakeups/item, %u spurious, "
+           "%u lock waits, %u lock timeouts\n",
+           wait_names[wait],
+           (uint32_t)((uint64_t)get_sum.items * 1000 / CONFIG_APP_RUN_MS),
+           per_item / 100, per_item % 100,
+           put_sum.spurious + get_sum.spurious,
+           put_sum.lock_waits + get_sum.lock_waits,
+           put_sum.timeouts + get_sum.timeouts);
+
+    if (put_sum.items != get_sum.items + buf.count) {
+        printk("%u items put, %u taken, %u left: items lost\n",
+               put_sum.items, get_sum.items, buf.count);
+    }
+}
+
+void bounded_buffer_main(void) {
+    k_mutex_init(&buf_mx);
+    k_condvar_init(&not_full);
+    k_condvar_init(&not_empty);
+
+    printk("bounded buffer: %d producers, %d consumers, %d slots, "
+           "%d/%d us per item, %d ms per case\n",
+           CONFIG_APP_PRODUCERS, CONFIG_APP_CONSUMERS, CONFIG_APP_BUFFER_SIZE,
+           PRODUCE_US, CONSUME_US, CONFIG_APP_RUN_MS);
+
+    for (int wait = 0; wait < WAIT_KINDS; wait++) {
+        run_case(wait);
+    }
+}
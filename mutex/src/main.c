@@ -1,61 +1,156 @@
 #include <zephyr/kernel.h>
+#include <zephyr/init.h>
 #include <zephyr/sys/printk.h>
 
-#define STACK_SIZE 500
+#include "bootprof.h"
+#include "periodic.h"
+#include "rtstats.h"
+#include "usermode.h"
+#include "workloads.h"
+
+#define STACK_SIZE 1024
 #define PRIORITY 5
 
+#define PERIOD_MS 1000
+#define REPORT_EVERY 10
+
+/*
+ * The counter threads are static unless CONFIG_APP_DYNAMIC_THREADS asks for
+ * the old run-time creation in main(), kept to compare boot times.
+ */
+#define STATIC_THREADS (IS_ENABLED(CONFIG_APP_WORKLOAD_COUNTER) && \
+                        !IS_ENABLED(CONFIG_APP_DYNAMIC_THREADS))
+
+/* user threads are started by main() once they are in the app memory domain */
+#if defined(CONFIG_USERSPACE)
+#define START_DELAY SYS_FOREVER_MS
+#else
+#define START_DELAY 0
+#endif
+
 typedef struct k_mutex mutex;
 typedef struct k_thread thread;
 
-mutex mx;
+K_MUTEX_DEFINE(mx);
 
-int data = 0;
+USERMODE_DATA int data = 0;
 
+#if defined(CONFIG_APP_DYNAMIC_THREADS)
 K_THREAD_STACK_DEFINE(thread_a_stack_area, STACK_SIZE);
 static thread thread_a;
 
 K_THREAD_STACK_DEFINE(thread_b_stack_area, STACK_SIZE);
 static thread thread_b;
+#endif
 
-void mtx_func() {
-    char* this_thread_name;
+static USERMODE_DATA PERIODIC_TASK_DEFINE(thread_a_task, PERIOD_MS, 0, 0);
+static USERMODE_DATA PERIODIC_TASK_DEFINE(thread_b_task, PERIOD_MS, 0, PERIOD_MS / 2);
+
+/* shown by the "rtstats" shell command */
+static USERMODE_BSS struct rtstats_mutex mx_stats;
+static struct rtstats_thread thread_a_stats;
+static struct rtstats_thread thread_b_stats;
+
+/*
+ * The lock only covers the update; the thread then sleeps until its next
+ * release instead of sleeping a fixed time while still holding the mutex.
+ */
+void mtx_func(struct periodic_task *task) {
+    char this_thread_name[32] = "";
     thread *current_thread;
     current_thread = k_current_get();
-    this_thread_name = k_thread_name_get(current_thread);
+    /* a copy: user threads cannot read the thread struct */
+    k_thread_name_copy(current_thread, this_thread_name, sizeof(this_thread_name));
+
+    bootprof_mark(BOOTPROF_FIRST_THREAD);
+    periodic_task_start(task);
 
     while(1) {
-        if(k_mutex_lock(&mx, K_MSEC(2000)) == 0) {
+        if(rtstats_mutex_lock(&mx_stats, K_MSEC(2000)) == 0) {
             data = data + 1;
+            bootprof_mark(BOOTPROF_FIRST_UART);
             printk("%s %d\n", this_thread_name, data);
-            k_sleep(K_MSEC(1000));
             k_mutex_unlock(&mx);
         }
+        bootprof_report();
+
+        if (task->stats.jobs % REPORT_EVERY == 0) {
+            periodic_task_report(task);
+        }
+        periodic_task_wait(task);
     }
 }
 
 void thread_a_entry(void *nothing_0, void *nothing_1, void *nothing_2) {
-    mtx_func();
+    mtx_func(&thread_a_task);
 }
 
 void thread_b_entry(void *nothing_0, void *nothing_1, void *nothing_2) {
-    mtx_func();
+    mtx_func(&thread_b_task);
+}
+
+#if STATIC_THREADS
+K_THREAD_DEFINE(thread0, STACK_SIZE, thread_a_entry, NULL, NULL, NULL,
+                PRIORITY, USERMODE_OPTIONS, START_DELAY);
+K_THREAD_DEFINE(thread1, STACK_SIZE, thread_b_entry, NULL, NULL, NULL,
+                PRIORITY, USERMODE_OPTIONS, START_DELAY);
+K_THREAD_ACCESS_GRANT(thread0, &mx);
+K_THREAD_ACCESS_GRANT(thread1, &mx);
+#endif
+
+/* runs before the static threads start, so they never lock an unregistered mutex */
+static int register_stats(void) {
+    rtstats_register_mutex(&mx_stats, "mx", &mx);
+#if STATIC_THREADS
+    rtstats_register_thread(&thread_a_stats, "thread0", thread0);
+    rtstats_register_thread(&thread_b_stats, "thread1", thread1);
+#endif
+    return 0;
 }
 
+SYS_INIT(register_stats, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+
 void main() {
-    k_mutex_init(&mx);
+    bootprof_mark(BOOTPROF_MAIN);
+
+#if defined(CONFIG_APP_WORKLOAD_READ_MOSTLY)
+    read_mostly_main();
+    return;
+#elif defined(CONFIG_APP_WORKLOAD_SYSCALL_COST)
+    syscall_cost_main();
+    return;
+#elif defined(CONFIG_APP_WORKLOAD_BOUNDED_BUFFER)
+    bounded_buffer_main();
+    return;
+#endif
 
+#if STATIC_THREADS && defined(CONFIG_USERSPACE)
+    usermode_start((const k_tid_t[]){ thread0, thread1 }, 2);
+#endif
+
+#if defined(CONFIG_APP_DYNAMIC_THREADS)
     k_thread_create(&thread_a, thread_a_stack_area,
                     K_THREAD_STACK_SIZEOF(thread_a_stack_area),
                     thread_a_entry, NULL, NULL, NULL,
-                    PRIORITY, 0, K_FOREVER);
+                    PRIORITY, USERMODE_OPTIONS, K_FOREVER);
     k_thread_name_set(&thread_a, "thread0");
 
     k_thread_create(&thread_b, thread_b_stack_area,
                     K_THREAD_STACK_SIZEOF(thread_b_stack_area),
                     thread_b_entry, NULL, NULL, NULL,
-                    PRIORITY, 0, K_FOREVER);
+                    PRIORITY, USERMODE_OPTIONS, K_FOREVER);
     k_thread_name_set(&thread_b, "thread1");
 
+    rtstats_register_thread(&thread_a_stats, "thread0", &thread_a);
+    rtstats_register_thread(&thread_b_stats, "thread1", &thread_b);
+
+#if defined(CONFIG_USERSPACE)
+    k_object_access_grant(&mx, &thread_a);
+    k_object_access_grant(&mx, &thread_b);
+    usermode_start((const k_tid_t[]){ &thread_a, &thread_b }, 2);
+#else
     k_thread_start(&thread_a);
     k_thread_start(&thread_b);
+#endif
+#endif
 }
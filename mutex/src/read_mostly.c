@@ -0,0 +1,229 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/atomic.h>
+#include <string.h>
+
+#include "rwlock.h"
+#include "seqlock.h"
+#include "workloads.h"
+
+/*
+ * Read-mostly workload: N readers keep copying a calibration table while a
+ * single writer replaces it every WRITE_PERIOD_MS. The same workload runs
+ * under a k_mutex, a reader-writer lock and a seqlock, for 1, 2, 4, ...
+ * CONFIG_APP_READERS_MAX readers.
+ */
+
+#define STACK_SIZE 1024
+#define READER_PRIORITY 7
+#define WRITER_PRIORITY 5
+
+#define WRITE_PERIOD_MS 10
+#define CALIB_POINTS 32
+
+/* more than one word, so a reader can see half of an update */
+struct calib {
+    uint32_t gen;
+    int16_t table[CALIB_POINTS];
+    uint32_t check;
+};
+
+enum lock_kind {
+    LOCK_MUTEX,
+    LOCK_RWLOCK,
+    LOCK_SEQLOCK,
+    LOCK_KINDS,
+};
+
+static const char *const lock_names[LOCK_KINDS] = {
+    [LOCK_MUTEX] = "k_mutex",
+    [LOCK_RWLOCK] = "rwlock",
+    [LOCK_SEQLOCK] = "seqlock",
+};
+
+/* one cache line each so the readers do not share counters */
+struct reader_stats {
+    uint32_t reads;
+    uint32_t torn;
+    uint32_t retries;
+} __aligned(64);
+
+static struct calib shared;
+static enum lock_kind kind;
+
+static struct k_mutex shared_mx;
+static struct rwlock shared_rw;
+static struct seqlock shared_seq;
+
+static atomic_t running;
+
+static struct reader_stats reader_stats[CONFIG_APP_READERS_MAX];
+
+static uint32_t writes;
+static uint64_t write_cycles_sum;
+static uint32_t write_cycles_max;
+
+K_THREAD_STACK_ARRAY_DEFINE(reader_stacks, CONFIG_APP_READERS_MAX, STACK_SIZE);
+static struct k_thread readers[CONFIG_APP_READERS_MAX];
+
+K_THREAD_STACK_DEFINE(writer_stack, STACK_SIZE);
+static struct k_thread writer;
+
+static uint32_t calib_check(const struct calib *c) {
+    uint32_t sum = c->gen;
+
+    for (int i = 0; i < CALIB_POINTS; i++) {
+        sum = sum * 31 + (uint16_t)c->table[i];
+    }
+    return sum;
+}
+
+static void shared_read(struct calib *out, struct reader_stats *stats) {
+    atomic_val_t seq;
+
+    switch (kind) {
+    case LOCK_MUTEX:
+        k_mutex_lock(&shared_mx, K_FOREVER);
+        memcpy(out, &shared, sizeof(shared));
+        k_mutex_unlock(&shared_mx);
+        break;
+    case LOCK_RWLOCK:
+        rwlock_read_lock(&shared_rw);
+        memcpy(out, &shared, sizeof(shared));
+        rwlock_read_unlock(&shared_rw);
+        break;
+    case LOCK_SEQLOCK:
+        seq = seqlock_read_begin(&shared_seq);
+        memcpy(out, &shared, sizeof(shared));
+        while (seqlock_read_retry(&shared_seq, seq)) {
+            stats->retries++;
+            seq = seqlock_read_begin(&shared_seq);
+            memcpy(out, &shared, sizeof(shared));
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void shared_write(const struct calib *in) {
+    k_spinlock_key_t key;
+
+    switch (kind) {
+    case LOCK_MUTEX:
+        k_mutex_lock(&shared_mx, K_FOREVER);
+        memcpy(&shared, in, sizeof(shared));
+        k_mutex_unlock(&shared_mx);
+        break;
+    case LOCK_RWLOCK:
+        rwlock_write_lock(&shared_rw);
+        memcpy(&shared, in, sizeof(shared));
+        rwlock_write_unlock(&shared_rw);
+        break;
+    case LOCK_SEQLOCK:
+        key = seqlock_write_begin(&shared_seq);
+        memcpy(&shared, in, sizeof(shared));
+        seqlock_write_end(&shared_seq, key);
+        break;
+    default:
+        break;
+    }
+}
+
+void reader_entry(void *stats_ptr, void *nothing_1, void *nothing_2) {
+    struct reader_stats *stats = stats_ptr;
+    struct calib copy;
+
+    while (atomic_get(&running)) {
+        shared_read(&copy, stats);
+        if (copy.check != calib_check(&copy)) {
+            stats->torn++;
+        }
+        stats->reads++;
+    }
+}
+
+void writer_entry(void *nothing_0, void *nothing_1, void *nothing_2) {
+    struct calib next = shared;
+    uint32_t start, cycles;
+
+    while (atomic_get(&running)) {
+        next.gen++;
+        for (int i = 0; i < CALIB_POINTS; i++) {
+            next.table[i] = (int16_t)(next.gen * (i + 1));
+        }
+        next.check = calib_check(&next);
+
+        start = k_cycle_get_32();
+        shared_write(&next);
+        cycles = k_cycle_get_32() - start;
+
+        writes++;
+        write_cycles_sum += cycles;
+        if (cycles > write_cycles_max) {
+            write_cycles_max = cycles;
+        }
+
+        k_msleep(WRITE_PERIOD_MS);
+    }
+}
+
+static void run_case(enum lock_kind lock, int n_readers) {
+    uint64_t reads = 0;
+    uint32_t torn = 0, retries = 0;
+
+    kind = lock;
+    memset(reader_stats, 0, sizeof(reader_stats));
+    writes = 0;
+    write_cycles_sum = 0;
+    write_cycles_max = 0;
+    atomic_set(&running, 1);
+
+    for (int i = 0; i < n_readers; i++) {
+        k_thread_create(&readers[i], reader_stacks[i],
+                        K_THREAD_STACK_SIZEOF(reader_stacks[i]),
+                        reader_entry, &reader_stats[i], NULL, NULL,
+                        READER_PRIORITY, 0, K_NO_WAIT);
+    }
+    k_thread_create(&writer, writer_stack,
+                    K_THREAD_STACK_SIZEOF(writer_stack),
+                    writer_entry, NULL, NULL, NULL,
+                    WRITER_PRIORITY, 0, K_NO_WAIT);
+
+    k_msleep(CONFIG_APP_RUN_MS);
+    atomic_set(&running, 0);
+
+    k_thread_join(&writer, K_FOREVER);
+    for (int i = 0; i < n_readers; i++) {
+        k_thread_join(&readers[i], K_FOREVER);
+        reads += reader_stats[i].reads;
+        torn += reader_stats[i].torn;
+        retries += reader_stats[i].retries;
+    }
+
+    printk("%-8s readers %d: %u reads/s, writer avg/max %u/%u ns, "
+           "retries %u, torn %u\n",
+           lock_names[lock], n_readers,
+           (uint32_t)(reads * 1000 / CONFIG_APP_RUN_MS),
+           writes ? (uint32_t)k_cyc_to_ns_floor64(write_cycles_sum / writes) : 0,
+           (uint32_t)k_cyc_to_ns_floor64(write_cycles_max),
+           retries, torn);
+}
+
+void read_mostly_main(void) {
+    k_mutex_init(&shared_mx);
+    rwlock_init(&shared_rw);
+
+    shared.check = calib_check(&shared);
+
+    printk("read-mostly: %u cpus, %d bytes payload, write every %d ms, "
+           "%d ms per case\n",
+           arch_num_cpus(), (int)sizeof(struct calib), WRITE_PERIOD_MS,
+           CONFIG_APP_RUN_MS);
+
+    for (int lock = 0; lock < LOCK_KINDS; lock++) {
+        for (int n = 1; n <= CONFIG_APP_READERS_MAX; n *= 2) {
+            run_case(lock, n);
+        }
+    }
+}
@@ -0,0 +1,139 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/timing/timing.h>
+
+#include "usermode.h"
+#include "workloads.h"
+
+/*
+ * Syscall cost workload: the same loops of uncontended kernel calls run
+ * once in a supervisor thread and once in a K_USER thread, and the cycles
+ * per iteration are printed side by side. A user thread pays for the trap
+ * and for the kernel checking every object pointer it passes in.
+ *
+ * The loops are timed with the timing API: on x86 that is the TSC, which
+ * user threads can read, unlike the system timer behind k_cycle_get_32().
+ */
+
+#define STACK_SIZE 1024
+#define PRIORITY 5
+
+#define LOOPS 10000
+
+enum op {
+    OP_UPTIME,
+    OP_SEM,
+    OP_MSGQ,
+    OP_MUTEX,
+    OPS,
+};
+
+static const char *const op_names[OPS] = {
+    [OP_UPTIME] = "k_uptime_ticks",
+    [OP_SEM] = "k_sem give+take",
+    [OP_MSGQ] = "k_msgq put+get",
+    [OP_MUTEX] = "k_mutex lock+unlock",
+};
+
+struct span {
+    timing_t start;
+    timing_t end;
+};
+
+K_SEM_DEFINE(bench_sem, 0, 1);
+K_MSGQ_DEFINE(bench_msgq, sizeof(uint32_t), 1, 4);
+K_MUTEX_DEFINE(bench_mutex);
+
+K_THREAD_STACK_DEFINE(bench_stack, STACK_SIZE);
+static struct k_thread bench_thread;
+
+/* written by the benchmark thread, in user mode too */
+static USERMODE_BSS struct span spans[OPS];
+
+static void bench_entry(void *p1, void *p2, void *p3) {
+    struct span *s = p1;
+    uint32_t item = 0;
+
+    s[OP_UPTIME].start = timing_counter_get();
+    for (int i = 0; i < LOOPS; i++) {
+        (void)k_uptime_ticks();
+    }
+    s[OP_UPTIME].end = timing_counter_get();
+
+    s[OP_SEM].start = timing_counter_get();
+    for (int i = 0; i < LOOPS; i++) {
+        k_sem_give(&bench_sem);
+        k_sem_take(&bench_sem, K_NO_WAIT);
+    }
+    s[OP_SEM].end = timing_counter_get();
+
+    s[OP_MSGQ].start = timing_counter_get();
+    for (int i = 0; i < LOOPS; i++) {
+        k_msgq_put(&bench_msgq, &item, K_NO_WAIT);
+        k_msgq_get(&bench_msgq, &item, K_NO_WAIT);
+    }
+    s[OP_MSGQ].end = timing_counter_get();
+
+    s[OP_MUTEX].start = timing_counter_get();
+    for (int i = 0; i < LOOPS; i++) {
+        k_mutex_lock(&bench_mutex, K_FOREVER);
+        k_mutex_unlock(&bench_mutex);
+    }
+    s[OP_MUTEX].end = timing_counter_get();
+}
+
+/* run the loops in a fresh thread and return the cycles per iteration */
+static void run(uint32_t options, uint64_t per_loop[OPS]) {
+    k_thread_create(&bench_thread, bench_stack,
+                    K_THREAD_STACK_SIZEOF(bench_stack),
+                    bench_entry, spans, NULL, NULL,
+                    PRIORITY, options, K_FOREVER);
+
+#if defined(CONFIG_USERSPACE)
+    if (options & K_USER) {
+        k_thread_access_grant(&bench_thread, &bench_sem, &bench_msgq,
+                              &bench_mutex);
+        usermode_start((const k_tid_t[]){ &bench_thread }, 1);
+    } else {
+        k_thread_start(&bench_thread);
+    }
+#else
+    k_thread_start(&bench_thread);
+#endif
+
+    k_thread_join(&bench_thread, K_FOREVER);
+
+    for (int op = 0; op < OPS; op++) {
+        per_loop[op] = timing_cycles_get(&spans[op].start, &spans[op].end) / LOOPS;
+    }
+}
+
+void syscall_cost_main(void) {
+    uint64_t kernel[OPS];
+#if defined(CONFIG_USERSPACE)
+    uint64_t user[OPS];
+#endif
+
+    timing_init();
+    timing_start();
+
+    run(0, kernel);
+#if defined(CONFIG_USERSPACE)
+    run(K_USER, user);
+#endif
+
+    printk("syscall cost, cycles per iteration (%d iterations, %u MHz):\n",
+           LOOPS, (uint32_t)(timing_freq_get() / 1000000));
+    printk("%-20s %8s %8s\n", "", "kernel", "user");
+    for (int op = 0; op < OPS; op++) {
+#if defined(CONFIG_USERSPACE)
+        printk("%-20s %8u %8u (+%u ns)\n", op_names[op],
+               (uint32_t)kernel[op], (uint32_t)user[op],
+               (uint32_t)(timing_cycles_to_ns(user[op] - MIN(user[op], kernel[op]))));
+#else
+        printk("%-20s %8u %8s\n", op_names[op], (uint32_t)kernel[op], "-");
+#endif
+    }
+
+    timing_stop();
+}
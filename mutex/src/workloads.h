@@ -0,0 +1,10 @@
+#ifndef WORKLOADS_H_
+#define WORKLOADS_H_
+
+/* alternative workloads, picked with CONFIG_APP_WORKLOAD_* (see Kconfig) */
+
+void read_mostly_main(void);
+void syscall_cost_main(void);
+void bounded_buffer_main(void);
+
+#endif /* WORKLOADS_H_ */
@@ -0,0 +1,180 @@
+/*
+ * Synthetic acquire -> filter -> encode -> transmit pipeline.
+ *
+ * Each stage burns a fixed cost per call plus a cost per item with
+ * k_busy_wait(), so batching pays off the way it does with real drivers
+ * (one DMA setup, one radio wakeup...). The source runs as fast as the
+ * queues let it, so the pipeline settles at the rate of its slowest stage
+ * and the report every REPORT_MS points at it.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+
+#include "pipeline.h"
+
+/* scheduling priority used by each stage */
+#define PRIORITY 7
+
+#define QUEUE_DEPTH 16
+#define REPORT_MS 2000
+
+/* per call / per item cost of each stage, in us */
+#define ACQUIRE_CALL_US		20
+#define ACQUIRE_ITEM_US		10
+#define FILTER_CALL_US		5
+#define FILTER_ITEM_US		40
+#define ENCODE_CALL_US		30
+#define ENCODE_ITEM_US		60
+#define TRANSMIT_CALL_US	100
+#define TRANSMIT_ITEM_US	15
+
+/* largest batch each stage takes */
+#define ACQUIRE_BATCH	4
+#define FILTER_BATCH	4
+#define ENCODE_BATCH	4
+#define TRANSMIT_BATCH	8
+
+#define FILTER_TAPS 4
+
+struct sample {
+	uint32_t seq;
+	uint32_t acquired;	/* k_cycle_get_32() at acquisition */
+	int16_t value;
+};
+
+struct frame {
+	uint32_t seq;
+	uint32_t acquired;
+	uint8_t payload[8];
+};
+
+/* written by the transmit stage, read and cleared by the report loop */
+static atomic_t latency_sum_us;
+static atomic_t latency_max_us;
+static atomic_t latency_count;
+
+size_t acquire(const void *in, size_t n_in, void *out, size_t max_out)
+{
+	static uint32_t seq;
+	struct sample *samples = out;
+
+	k_busy_wait(ACQUIRE_CALL_US + max_out * ACQUIRE_ITEM_US);
+
+	for (size_t i = 0; i < max_out; i++) {
+		samples[i].seq = seq++;
+		samples[i].acquired = k_cycle_get_32();
+		samples[i].value = (int16_t)((seq * 37) % 2048 - 1024);
+	}
+
+	return max_out;
+}
+
+size_t filter(const void *in, size_t n_in, void *out, size_t max_out)
+{
+	static int16_t taps[FILTER_TAPS];
+	static int tap;
+	const struct sample *raw = in;
+	struct sample *filtered = out;
+	int32_t sum;
+
+	k_busy_wait(FILTER_CALL_US + n_in * FILTER_ITEM_US);
+
+	for (size_t i = 0; i < n_in; i++) {
+		taps[tap] = raw[i].value;
+		tap = (tap + 1) % FILTER_TAPS;
+
+		sum = 0;
+		for (int t = 0; t < FILTER_TAPS; t++) {
+			sum += taps[t];
+		}
+
+		filtered[i] = raw[i];
+		filtered[i].value = (int16_t)(sum / FILTER_TAPS);
+	}
+
+	return n_in;
+}
+
+size_t encode(const void *in, size_t n_in, void *out, size_t max_out)
+{
+	const struct sample *samples = in;
+	struct frame *frames = out;
+
+	k_busy_wait(ENCODE_CALL_US + n_in * ENCODE_ITEM_US);
+
+	for (size_t i = 0; i < n_in; i++) {
+		frames[i].seq = samples[i].seq;
+		frames[i].acquired = samples[i].acquired;
+		for (int b = 0; b < sizeof(frames[i].payload); b++) {
+			frames[i].payload[b] = (uint8_t)(samples[i].value >> (b % 2 * 8));
+		}
+	}
+
+	return n_in;
+}
+
+size_t transmit(const void *in, size_t n_in, void *out, size_t max_out)
+{
+	const struct frame *frames = in;
+	uint32_t now;
+	atomic_val_t latency, max;
+
+	k_busy_wait(TRANSMIT_CALL_US + n_in * TRANSMIT_ITEM_US);
+
+	now = k_cycle_get_32();
+	for (size_t i = 0; i < n_in; i++) {
+		latency = k_cyc_to_us_floor32(now - frames[i].acquired);
+		atomic_add(&latency_sum_us, latency);
+		atomic_inc(&latency_count);
+		do {
+			max = atomic_get(&latency_max_us);
+		} while (latency > max && !atomic_cas(&latency_max_us, max, latency));
+	}
+
+	return 0;
+}
+
+PIPELINE_QUEUE_DEFINE(raw_q, struct sample, QUEUE_DEPTH);
+PIPELINE_QUEUE_DEFINE(filtered_q, struct sample, QUEUE_DEPTH);
+PIPELINE_QUEUE_DEFINE(frame_q, struct frame, QUEUE_DEPTH);
+
+PIPELINE_SOURCE_DEFINE(acquire_stage, acquire, raw_q, struct sample,
+		       ACQUIRE_BATCH, PRIORITY);
+PIPELINE_STAGE_DEFINE(filter_stage, filter, raw_q, struct sample,
+		      filtered_q, struct sample, FILTER_BATCH, PRIORITY);
+PIPELINE_STAGE_DEFINE(encode_stage, encode, filtered_q, struct sample,
+		      frame_q, struct frame, ENCODE_BATCH, PRIORITY);
+PIPELINE_SINK_DEFINE(transmit_stage, transmit, frame_q, struct frame,
+		     TRANSMIT_BATCH, PRIORITY);
+
+static struct pipeline_stage *const stages[] = {
+	&acquire_stage,
+	&filter_stage,
+	&encode_stage,
+	&transmit_stage,
+};
+
+void main(void)
+{
+	uint32_t sum, max, count;
+
+	printk("pipeline: %d stages, queue depth %d, batches %d/%d/%d/%d\n",
+	       (int)ARRAY_SIZE(stages), QUEUE_DEPTH, ACQUIRE_BATCH,
+	       FILTER_BATCH, ENCODE_BATCH, TRANSMIT_BATCH);
+
+	while (1) {
+		k_msleep(REPORT_MS);
+
+		pipeline_report(stages, ARRAY_SIZE(stages), REPORT_MS);
+
+		sum = atomic_clear(&latency_sum_us);
+		max = atomic_clear(&latency_max_us);
+		count = atomic_clear(&latency_count);
+		if (count) {
+			printk("end to end latency avg/max %u/%u us\n",
+			       sum / count, max);
+		}
+	}
+}
@@ -0,0 +1,447 @@
+/*
+ * Button/LED chase (loading_leds_and_button.c) and UART echo (uart/) in one
+ * app, either on a single reactor thread or, with CONFIG_APP_THREAD_PER_TASK,
+ * with one thread per behaviour as before. Both print the stack RAM of
+ * every thread and the event -> handler latency every REPORT_TIME_MS.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/sys/printk.h>
+#include <string.h>
+
+#include "reactor.h"
+
+#define DEBOUNCE_TIME_MS 10
+#define CHASE_TIME_MS	100
+#define REPORT_TIME_MS	10000
+
+/* thread-per-task baseline */
+#define STACKSIZE 1024
+#define PRIORITY 7
+
+#define UART_DEVICE_NODE DT_CHOSEN(zephyr_shell_uart)
+
+#define MSG_SIZE 32
+
+K_MSGQ_DEFINE(uart_msgq, MSG_SIZE, 10, 4);
+
+static const struct device *const uart_dev = DEVICE_DT_GET(UART_DEVICE_NODE);
+
+static char rx_buf[MSG_SIZE];
+static int rx_buf_pos;
+
+/* button and LEDs are optional, qemu boards have neither */
+static const struct gpio_dt_spec button = GPIO_DT_SPEC_GET_OR(DT_ALIAS(sw0), gpios, {0});
+static struct gpio_callback button_cb_data;
+
+/* chase order of the original sample: led0, led1, led3, led2 */
+static const struct gpio_dt_spec chase[] = {
+	GPIO_DT_SPEC_GET_OR(DT_ALIAS(led0), gpios, {0}),
+	GPIO_DT_SPEC_GET_OR(DT_ALIAS(led1), gpios, {0}),
+	GPIO_DT_SPEC_GET_OR(DT_ALIAS(led3), gpios, {0}),
+	GPIO_DT_SPEC_GET_OR(DT_ALIAS(led2), gpios, {0}),
+};
+
+static bool party_on;
+static int chase_pos;
+
+/* behaviour, shared by both designs */
+
+bool is_pressed()
+{
+	return gpio_pin_get_dt(&button) == 0;
+}
+
+static void leds_off(void)
+{
+	for (int i = 0; i < ARRAY_SIZE(chase); i++) {
+		if (chase[i].port) {
+			gpio_pin_set_dt(&chase[i], 0);
+		}
+	}
+}
+
+static void debounce_done(void)
+{
+	if (!is_pressed()) {
+		return;
+	}
+
+	party_on = !party_on;
+	if (!party_on) {
+		leds_off();
+	}
+}
+
+static void chase_step(void)
+{
+	if (!party_on) {
+		return;
+	}
+
+	chase_pos = (chase_pos + 1) % ARRAY_SIZE(chase);
+	if (chase[chase_pos].port) {
+		gpio_pin_toggle_dt(&chase[chase_pos]);
+	}
+}
+
+/*
+ * print_uart() and serial_cb() are the msgq versions from the original
+ * uart sample. uart/ has since moved to a lock-free ring with its own
+ * counters, and the reactor waits on a k_msgq, so they are kept here
+ * rather than shared.
+ */
+void print_uart(char *buf)
+{
+	int msg_len = strlen(buf);
+
+	for (int i = 0; i < msg_len; i++) {
+		uart_poll_out(uart_dev, buf[i]);
+	}
+}
+
+static void echo_line(char *line)
+{
+	print_uart("Echo: ");
+	print_uart(line);
+	print_uart("\r\n");
+}
+
+static void stack_usage(const struct k_thread *cthread, void *user_data)
+{
+	struct k_thread *thread = (struct k_thread *)cthread;
+	size_t *total = user_data;
+	size_t unused = 0;
+	const char *name = k_thread_name_get(thread);
+
+	k_thread_stack_space_get(thread, &unused);
+	printk("  %-12s stack %4u bytes, used %4u\n", name ? name : "?",
+	       (uint32_t)thread->stack_info.size,
+	       (uint32_t)(thread->stack_info.size - unused));
+
+	total[0] += thread->stack_info.size;
+	total[1] += thread->stack_info.size - unused;
+}
+
+static void stack_report(void)
+{
+	size_t total[2] = {0, 0};
+
+	k_thread_foreach(stack_usage, total);
+	printk("  total        stack %4u bytes, used %4u\n",
+	       (uint32_t)total[0], (uint32_t)total[1]);
+}
+
+#if !defined(CONFIG_APP_THREAD_PER_TASK)
+
+static struct reactor reactor;
+static struct reactor_source button_src;
+static struct reactor_source uart_src;
+static struct reactor_timer debounce;
+static struct reactor_timer chase_timer;
+static struct reactor_timer report_timer;
+
+static void raise_button(void)
+{
+	reactor_raise(&button_src);
+}
+
+static void stamp_uart(void)
+{
+	reactor_stamp(&uart_src);
+}
+
+static void on_button(struct reactor_source *src)
+{
+	k_timer_start(&debounce.timer, K_MSEC(DEBOUNCE_TIME_MS), K_NO_WAIT);
+}
+
+static void on_debounce(struct reactor_source *src)
+{
+	debounce_done();
+}
+
+static void on_chase(struct reactor_source *src)
+{
+	chase_step();
+}
+
+static void on_uart(struct reactor_source *src)
+{
+	char tx_buf[MSG_SIZE];
+
+	/* msgq sources stay ready until the queue is empty */
+	while (k_msgq_get(&uart_msgq, &tx_buf, K_NO_WAIT) == 0) {
+		echo_line(tx_buf);
+	}
+}
+
+static void on_report(struct reactor_source *src)
+{
+	printk("reactor:\n");
+	reactor_report(&reactor);
+	stack_report();
+}
+
+static void run(void)
+{
+	reactor_init(&reactor);
+	if (reactor_add_signal(&reactor, &button_src, "button", on_button) != 0 ||
+	    reactor_add_msgq(&reactor, &uart_src, "uart", &uart_msgq, on_uart) != 0 ||
+	    reactor_add_timer(&reactor, &debounce, "debounce", on_debounce) != 0 ||
+	    reactor_add_timer(&reactor, &chase_timer, "chase", on_chase) != 0 ||
+	    reactor_add_timer(&reactor, &report_timer, "report", on_report) != 0) {
+		printk("Error: more sources than REACTOR_MAX_SOURCES (%d)\n",
+		       REACTOR_MAX_SOURCES);
+		return;
+	}
+
+	k_timer_start(&chase_timer.timer, K_MSEC(CHASE_TIME_MS), K_MSEC(CHASE_TIME_MS));
+	k_timer_start(&report_timer.timer, K_MSEC(REPORT_TIME_MS), K_MSEC(REPORT_TIME_MS));
+
+	reactor_run(&reactor);
+}
+
+#else /* CONFIG_APP_THREAD_PER_TASK */
+
+/* same bookkeeping as a reactor source, for the thread wakeups */
+struct wake_stats {
+	const char *name;
+	uint32_t stamp;
+	uint32_t wakeups;
+	uint32_t measured;
+	uint32_t latency_max;
+	uint64_t latency_sum;
+};
+
+static struct wake_stats button_wake = { .name = "button" };
+static struct wake_stats uart_wake = { .name = "uart" };
+static struct wake_stats chase_wake = { .name = "chase" };
+
+static void wake_stamp(struct wake_stats *w)
+{
+	if (w->stamp == 0) {
+		w->stamp = k_cycle_get_32();
+	}
+}
+
+static void wake_record(struct wake_stats *w)
+{
+	uint32_t stamp = w->stamp;
+	uint32_t latency;
+
+	w->stamp = 0;
+	w->wakeups++;
+	if (stamp == 0) {
+		return;
+	}
+
+	latency = k_cycle_get_32() - stamp;
+	w->measured++;
+	w->latency_sum += latency;
+	if (latency > w->latency_max) {
+		w->latency_max = latency;
+	}
+}
+
+static void wake_report(const struct wake_stats *w)
+{
+	if (w->measured == 0) {
+		printk("%s: %u wakeups\n", w->name, w->wakeups);
+		return;
+	}
+	printk("%s: %u wakeups, latency avg/max %u/%u ns\n", w->name, w->wakeups,
+	       (uint32_t)k_cyc_to_ns_floor64(w->latency_sum / w->measured),
+	       (uint32_t)k_cyc_to_ns_floor64(w->latency_max));
+}
+
+K_SEM_DEFINE(button_sem, 0, 1);
+
+static void chase_expired(struct k_timer *timer)
+{
+	wake_stamp(&chase_wake);
+}
+
+K_TIMER_DEFINE(chase_timer, chase_expired, NULL);
+
+K_THREAD_STACK_DEFINE(button_stack_area, STACKSIZE);
+static struct k_thread button_data;
+
+K_THREAD_STACK_DEFINE(chase_stack_area, STACKSIZE);
+static struct k_thread chase_data;
+
+K_THREAD_STACK_DEFINE(uart_stack_area, STACKSIZE);
+static struct k_thread uart_data;
+
+static void raise_button(void)
+{
+	wake_stamp(&button_wake);
+	k_sem_give(&button_sem);
+}
+
+static void stamp_uart(void)
+{
+	wake_stamp(&uart_wake);
+}
+
+void button_thread(void *dummy1, void *dummy2, void *dummy3)
+{
+	while (1) {
+		k_sem_take(&button_sem, K_FOREVER);
+		wake_record(&button_wake);
+
+		//DEBOUNCE
+		k_msleep(DEBOUNCE_TIME_MS);
+		debounce_done();
+	}
+}
+
+void chase_thread(void *dummy1, void *dummy2, void *dummy3)
+{
+	k_timer_start(&chase_timer, K_MSEC(CHASE_TIME_MS), K_MSEC(CHASE_TIME_MS));
+
+	while (1) {
+		k_timer_status_sync(&chase_timer);
+		wake_record(&chase_wake);
+		chase_step();
+	}
+}
+
+void uart_thread(void *dummy1, void *dummy2, void *dummy3)
+{
+	char tx_buf[MSG_SIZE];
+
+	while (k_msgq_get(&uart_msgq, &tx_buf, K_FOREVER) == 0) {
+		wake_record(&uart_wake);
+		echo_line(tx_buf);
+	}
+}
+
+static void run(void)
+{
+	k_thread_create(&button_data, button_stack_area,
+			K_THREAD_STACK_SIZEOF(button_stack_area),
+			button_thread, NULL, NULL, NULL,
+			PRIORITY, 0, K_FOREVER);
+	k_thread_name_set(&button_data, "button");
+
+	k_thread_create(&chase_data, chase_stack_area,
+			K_THREAD_STACK_SIZEOF(chase_stack_area),
+			chase_thread, NULL, NULL, NULL,
+			PRIORITY, 0, K_FOREVER);
+	k_thread_name_set(&chase_data, "chase");
+
+	k_thread_create(&uart_data, uart_stack_area,
+			K_THREAD_STACK_SIZEOF(uart_stack_area),
+			uart_thread, NULL, NULL, NULL,
+			PRIORITY, 0, K_FOREVER);
+	k_thread_name_set(&uart_data, "uart");
+
+	k_thread_start(&button_data);
+	k_thread_start(&chase_data);
+	k_thread_start(&uart_data);
+
+	while (1) {
+		k_msleep(REPORT_TIME_MS);
+		printk("thread per task:\n");
+		wake_report(&button_wake);
+		wake_report(&uart_wake);
+		wake_report(&chase_wake);
+		stack_report();
+	}
+}
+
+#endif /* CONFIG_APP_THREAD_PER_TASK */
+
+void button_pressed(const struct device *dev, struct gpio_callback *cb, uint32_t pins)
+{
+	raise_button();
+}
+
+void serial_cb(const struct device *dev, void *user_data)
+{
+	uint8_t c;
+
+	if (!uart_irq_update(uart_dev)) {
+		return;
+	}
+
+	while (uart_irq_rx_ready(uart_dev)) {
+
+		uart_fifo_read(uart_dev, &c, 1);
+
+		if ((c == '\n' || c == '\r') && rx_buf_pos > 0) {
+			/* terminate string */
+			rx_buf[rx_buf_pos] = '\0';
+
+			/* if queue is full, message is silently dropped */
+			if (k_msgq_put(&uart_msgq, &rx_buf, K_NO_WAIT) == 0) {
+				stamp_uart();
+			}
+
+			/* reset the buffer (it was copied to the msgq) */
+			rx_buf_pos = 0;
+		}
+		else if (rx_buf_pos < (sizeof(rx_buf) - 1)) {
+			rx_buf[rx_buf_pos++] = c;
+		}
+		/* else: characters beyond buffer size are dropped */
+	}
+}
+
+static int setup_button(void)
+{
+	int ret;
+
+	if (!button.port) {
+		return 0;
+	}
+	if (!device_is_ready(button.port)) {
+		printk("Error: button device %s is not ready\n", button.port->name);
+		return -ENODEV;
+	}
+
+	ret = gpio_pin_configure_dt(&button, GPIO_INPUT);
+	if (ret != 0) {
+		return ret;
+	}
+
+	ret = gpio_pin_interrupt_configure_dt(&button, GPIO_INT_EDGE_TO_ACTIVE);
+	if (ret != 0) {
+		return ret;
+	}
+
+	gpio_init_callback(&button_cb_data, button_pressed, BIT(button.pin));
+	gpio_add_callback(button.port, &button_cb_data);
+
+	return 0;
+}
+
+void main(void)
+{
+	for (int i = 0; i < ARRAY_SIZE(chase); i++) {
+		if (chase[i].port && device_is_ready(chase[i].port)) {
+			gpio_pin_configure_dt(&chase[i], GPIO_OUTPUT_LOW);
+		}
+	}
+
+	if (setup_button() != 0) {
+		return;
+	}
+
+	if (!device_is_ready(uart_dev)) {
+		printk("UART device not found!");
+		return;
+	}
+
+	uart_irq_callback_user_data_set(uart_dev, serial_cb, NULL);
+	uart_irq_rx_enable(uart_dev);
+
+	print_uart("Hello! I'm your echo bot.\r\n");
+	print_uart("Tell me something and press enter:\r\n");
+
+	run();
+}
@@ -10,15 +10,19 @@
 #include <zephyr/sys/printk.h>
 #include <zephyr/drivers/gpio.h>
 
+#include "bootprof.h"
+#include "periodic.h"
+#include "usermode.h"
+
 
 #define LED0_NODE DT_ALIAS(led0)
 #define LED1_NODE DT_ALIAS(led1)
 
 /*
  * The hello world demo has two threads that utilize semaphores and sleeping
- * to take turns printing a greeting message at a controlled rate. The demo
- * shows both the static and dynamic approaches for spawning a thread; a real
- * world application would likely use the static approach for both threads.
+ * to take turns printing a greeting message at a controlled rate. Both
+ * threads are static and each one sets up its own LED, so main() has nothing
+ * to do before the first greeting.
  */
 
 #define PIN_THREADS (IS_ENABLED(CONFIG_SMP)		  \
@@ -31,37 +35,76 @@
 /* scheduling priority used by each thread */
 #define PRIORITY 7
 
+/*
+ * Pinned threads are started by main() once they are on their CPU, user
+ * threads once they are in the app memory domain.
+ */
+#if PIN_THREADS || defined(CONFIG_USERSPACE)
+#define START_DELAY SYS_FOREVER_MS
+#else
+#define START_DELAY 0
+#endif
+
 /* delay between greetings (in ms) */
 #define SLEEPTIME 500
 
-static struct gpio_dt_spec led0 = GPIO_DT_SPEC_GET_OR(DT_ALIAS(led0), gpios, {0});
-static struct gpio_dt_spec led1 = GPIO_DT_SPEC_GET_OR(DT_ALIAS(led1), gpios, {0});
+/*
+ * Each thread owns one SLEEPTIME slot of a 2 * SLEEPTIME round: thread_a is
+ * released at the start of the round, thread_b half-way through. The slot
+ * is also the deadline, so a greeting that spills into the other thread's
+ * slot is counted as a miss.
+ */
+#define ROUND_MS (2 * SLEEPTIME)
+
+/* print the scheduling report every 10 rounds */
+#define REPORT_EVERY 10
+
+/* read by the threads, so it has to be in their partition in user mode */
+static USERMODE_DATA struct gpio_dt_spec led0 = GPIO_DT_SPEC_GET_OR(DT_ALIAS(led0), gpios, {0});
+static USERMODE_DATA struct gpio_dt_spec led1 = GPIO_DT_SPEC_GET_OR(DT_ALIAS(led1), gpios, {0});
 
 /*
  * @param my_name      thread identification string
  * @param my_sem       thread's own semaphore
  * @param other_sem    other thread's semaphore
+ * @param led          LED toggled with every greeting
+ * @param task         periodic task releasing this thread's greetings
  */
-void helloLoop(const char *my_name, struct k_sem *my_sem, struct k_sem *other_sem, struct gpio_dt_spec *led)
+void helloLoop(const char *my_name, struct k_sem *my_sem, struct k_sem *other_sem, struct gpio_dt_spec *led,
+	       struct periodic_task *task)
 {
+	char name_buf[32];
 	const char *tname;
 	uint8_t cpu;
 	struct k_thread *current_thread;
 
+	bootprof_mark(BOOTPROF_FIRST_THREAD);
+	if (led->port) {
+		gpio_pin_configure_dt(led, GPIO_OUTPUT_ACTIVE);
+		bootprof_mark(BOOTPROF_FIRST_GPIO);
+	}
+
+	periodic_task_start(task);
+
 	while (1) {
 		/* take my semaphore */
 		k_sem_take(my_sem, K_FOREVER);
 
-		gpio_pin_toggle_dt(led);
+		if (led->port) {
+			gpio_pin_toggle_dt(led);
+		}
 
 		current_thread = k_current_get();
-		tname = k_thread_name_get(current_thread);
-#if CONFIG_SMP
+		/* a copy: user threads cannot read the thread struct */
+		tname = k_thread_name_copy(current_thread, name_buf,
+					   sizeof(name_buf)) == 0 ? name_buf : NULL;
+#if CONFIG_SMP && !defined(CONFIG_USERSPACE)
 		cpu = arch_curr_cpu()->id;
 #else
 		cpu = 0;
 #endif
 		/* say "hello" */
+		bootprof_mark(BOOTPROF_FIRST_UART);
 		if (tname == NULL) {
 			printk("%s: Hello World from cpu %d on %s!\n",
 				my_name, cpu, CONFIG_BOARD);
@@ -70,10 +113,16 @@ void helloLoop(const char *my_name, struct k_sem *my_sem, struct k_sem *other_se
 				tname, cpu, CONFIG_BOARD);
 		}
 
-		/* wait a while, then let other thread have a turn */
+		bootprof_report();
+
+		/* work a while, let other thread have a turn, wait for my next slot */
 		k_busy_wait(100000);
-		k_msleep(SLEEPTIME);
 		k_sem_give(other_sem);
+
+		if (task->stats.jobs % REPORT_EVERY == 0) {
+			periodic_task_report(task);
+		}
+		periodic_task_wait(task);
 	}
 }
 
@@ -82,8 +131,11 @@ void helloLoop(const char *my_name, struct k_sem *my_sem, struct k_sem *other_se
 K_SEM_DEFINE(threadA_sem, 1, 1);	/* starts off "available" */
 K_SEM_DEFINE(threadB_sem, 0, 1);	/* starts off "not available" */
 
+static USERMODE_DATA PERIODIC_TASK_DEFINE(threadA_task, ROUND_MS, SLEEPTIME, 0);
+static USERMODE_DATA PERIODIC_TASK_DEFINE(threadB_task, ROUND_MS, SLEEPTIME, SLEEPTIME);
 
-/* threadB is a dynamic thread that is spawned by threadA */
+
+/* threadB is a static thread that is spawned automatically */
 
 void threadB(void *dummy1, void *dummy2, void *dummy3)
 {
@@ -92,14 +144,12 @@ void threadB(void *dummy1, void *dummy2, void *dummy3)
 	ARG_UNUSED(dummy3);
 
 	/* invoke routine to ping-pong hello messages with threadA */
-	helloLoop(__func__, &threadB_sem, &threadA_sem, &led1);
+	helloLoop(__func__, &threadB_sem, &threadA_sem, &led1, &threadB_task);
 }
 
-K_THREAD_STACK_DEFINE(threadA_stack_area, STACKSIZE);
-static struct k_thread threadA_data;
-
-K_THREAD_STACK_DEFINE(threadB_stack_area, STACKSIZE);
-static struct k_thread threadB_data;
+K_THREAD_DEFINE(thread_b, STACKSIZE, threadB, NULL, NULL, NULL,
+		PRIORITY, USERMODE_OPTIONS, START_DELAY);
+K_THREAD_ACCESS_GRANT(thread_b, &threadA_sem, &threadB_sem);
 
 /* threadA is a static thread that is spawned automatically */
 
@@ -110,31 +160,33 @@ void threadA(void *dummy1, void *dummy2, void *dummy3)
 	ARG_UNUSED(dummy3);
 
 	/* invoke routine to ping-pong hello messages with threadB */
-	helloLoop(__func__, &threadA_sem, &threadB_sem, &led0);
+	helloLoop(__func__, &threadA_sem, &threadB_sem, &led0, &threadA_task);
 }
 
+K_THREAD_DEFINE(thread_a, STACKSIZE, threadA, NULL, NULL, NULL,
+		PRIORITY, USERMODE_OPTIONS, START_DELAY);
+K_THREAD_ACCESS_GRANT(thread_a, &threadA_sem, &threadB_sem);
+
 void main(void)
 {
-	gpio_pin_configure_dt(&led0, GPIO_OUTPUT_ACTIVE);
-	gpio_pin_configure_dt(&led1, GPIO_OUTPUT_ACTIVE);
-	k_thread_create(&threadA_data, threadA_stack_area,
-			K_THREAD_STACK_SIZEOF(threadA_stack_area),
-			threadA, NULL, NULL, NULL,
-			PRIORITY, 0, K_FOREVER);
-	k_thread_name_set(&threadA_data, "thread_a");
-#if PIN_THREADS
-	k_thread_cpu_pin(&threadA_data, 0);
-#endif
+	bootprof_mark(BOOTPROF_MAIN);
 
-	k_thread_create(&threadB_data, threadB_stack_area,
-			K_THREAD_STACK_SIZEOF(threadB_stack_area),
-			threadB, NULL, NULL, NULL,
-			PRIORITY, 0, K_FOREVER);
-	k_thread_name_set(&threadB_data, "thread_b");
 #if PIN_THREADS
-	k_thread_cpu_pin(&threadB_data, 1);
+	k_thread_cpu_pin(thread_a, 0);
+	k_thread_cpu_pin(thread_b, 1);
 #endif
 
-	k_thread_start(&threadA_data);
-	k_thread_start(&threadB_data);
-}
\ No newline at end of file
+#if defined(CONFIG_USERSPACE)
+	/* the LEDs are driven through syscalls on their GPIO port */
+	if (led0.port) {
+		k_object_access_grant(led0.port, thread_a);
+	}
+	if (led1.port) {
+		k_object_access_grant(led1.port, thread_b);
+	}
+	usermode_start((const k_tid_t[]){ thread_a, thread_b }, 2);
+#elif PIN_THREADS
+	k_thread_start(thread_a);
+	k_thread_start(thread_b);
+#endif
+}
@@ -0,0 +1,43 @@
+import serial
+import sys
+import threading
+import time
+#usage: python flood.py COM3 [seconds]
+
+port = sys.argv[1] if len(sys.argv) > 1 else 'COM3'
+seconds = int(sys.argv[2]) if len(sys.argv) > 2 else 10
+
+ser = serial.Serial(port, 115200, timeout=1)
+
+sent = 0
+echoed = 0
+running = True
+
+def escrever():
+    #send small lines as fast as the port takes them
+    global sent
+    while running:
+        ser.write(b'%d\n' % (sent % 1000))
+        sent += 1
+
+def ler():
+    global echoed
+    while running:
+        line = ser.read_until()
+        if line.startswith(b'Echo: '):
+            echoed += 1
+        elif line:
+            print(line.decode(errors='replace').strip())
+
+t1 = threading.Thread(target=escrever)
+t2 = threading.Thread(target=ler)
+
+t1.start()
+t2.start()
+
+time.sleep(seconds)
+running = False
+t1.join()
+t2.join()
+
+print("sent %d lines, %d echoed, %.0f echoes/s" % (sent, echoed, echoed / seconds))
@@ -1,20 +1,126 @@
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
 #include <zephyr/drivers/uart.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
 
 #include <string.h>
 
+#include "bootprof.h"
+#include "rtstats.h"
+#include "spsc_ring.h"
+
 #define UART_DEVICE_NODE DT_CHOSEN(zephyr_shell_uart)
 
 #define MSG_SIZE 32
 
-K_MSGQ_DEFINE(uart_msgq, MSG_SIZE, 10, 4);
+/* lines the ISR can queue ahead of the echo loop */
+#define RING_LINES 16
+
+/*
+ * With a threshold of 1 the echo loop is woken when a line lands in an
+ * empty ring, and lines arriving while it echoes are picked up in the same
+ * pass. A higher threshold waits for that many lines instead, or FLUSH_MS
+ * after the first one, whichever comes first.
+ */
+#define WAKE_THRESHOLD 1
+#define FLUSH_MS 5
+
+#define REPORT_MS 5000
 
 static const struct device *const uart_dev = DEVICE_DT_GET(UART_DEVICE_NODE);
 
-static char rx_buf[MSG_SIZE];
+static char *rx_buf;
 static int rx_buf_pos;
 
+/*
+ * Counters for the current report window. The RX ISR counts lines in and
+ * dropped, so those are atomics that report() takes with atomic_clear().
+ */
+static atomic_t lines_in;
+static atomic_t lines_dropped;
+static uint32_t lines_out;
+static uint32_t bytes_out;
+static uint32_t wakeups;
+
+/*
+ * The UART carries the echo, so there is no shell here: the registry is
+ * printed with the report instead.
+ */
+static struct rtstats_thread main_stats;
+
+#if defined(CONFIG_APP_UART_MSGQ)
+
+K_MSGQ_DEFINE(uart_msgq, MSG_SIZE, 10, 4);
+
+static struct rtstats_msgq uart_msgq_stats;
+
+static char rx_line[MSG_SIZE];
+static char tx_line[MSG_SIZE];
+
+static char *line_start(void)
+{
+    return rx_line;
+}
+
+static void line_complete(char *line)
+{
+    /* if queue is full, message is silently dropped */
+    if (rtstats_msgq_put(&uart_msgq_stats, line, K_NO_WAIT) == 0) {
+        atomic_inc(&lines_in);
+    } else {
+        atomic_inc(&lines_dropped);
+    }
+}
+
+#else
+
+SPSC_RING_DEFINE(uart_lines, MSG_SIZE, RING_LINES);
+
+K_SEM_DEFINE(uart_wake, 0, 1);
+
+/* where a line goes when the ring is full, to be dropped at its end */
+static char rx_scratch[MSG_SIZE];
+
+static void flush_expired(struct k_timer *timer)
+{
+    k_sem_give(&uart_wake);
+}
+
+K_TIMER_DEFINE(uart_flush, flush_expired, NULL);
+
+static char *line_start(void)
+{
+    char *slot = spsc_ring_claim(&uart_lines);
+
+    return slot ? slot : rx_scratch;
+}
+
+static void line_complete(char *line)
+{
+    uint32_t queued;
+
+    if (line == rx_scratch) {
+        atomic_inc(&lines_dropped);
+        return;
+    }
+
+    queued = spsc_ring_publish(&uart_lines);
+    atomic_inc(&lines_in);
+
+    if (WAKE_THRESHOLD <= 1) {
+        if (queued == 0) {
+            k_sem_give(&uart_wake);
+        }
+    } else if (queued == 0) {
+        k_timer_start(&uart_flush, K_MSEC(FLUSH_MS), K_NO_WAIT);
+    } else if (queued + 1 == WAKE_THRESHOLD) {
+        k_sem_give(&uart_wake);
+    }
+}
+
+#endif /* CONFIG_APP_UART_MSGQ */
+
 void serial_cb(const struct device *dev, void *user_data)
 {
     uint8_t c;
@@ -27,43 +133,145 @@ void serial_cb(const struct device *dev, void *user_data)
 
         uart_fifo_read(uart_dev, &c, 1);
 
+        if (rx_buf_pos == 0) {
+            rx_buf = line_start();
+        }
+
         if ((c == '\n' || c == '\r') && rx_buf_pos > 0) {
             /* terminate string */
             rx_buf[rx_buf_pos] = '\0';
 
-            /* if queue is full, message is silently dropped */
-            k_msgq_put(&uart_msgq, &rx_buf, K_NO_WAIT);
+            line_complete(rx_buf);
 
-            /* reset the buffer (it was copied to the msgq) */
+            /* reset the buffer (it was handed to the echo loop) */
             rx_buf_pos = 0;
         }
-        else if (rx_buf_pos < (sizeof(rx_buf) - 1)) {
+        else if (rx_buf_pos < (MSG_SIZE - 1)) {
             rx_buf[rx_buf_pos++] = c;
         }
         /* else: characters beyond buffer size are dropped */
     }
 }
 
+void print_uart(char *buf)
+{
+    int msg_len = strlen(buf);
+
+    for (int i = 0; i < msg_len; i++) {
+        uart_poll_out(uart_dev, buf[i]);
+    }
+}
+
+static void echo_line(char *line)
+{
+    print_uart("Echo: ");
+    print_uart(line);
+    print_uart("\r\n");
+
+    lines_out++;
+    bytes_out += strlen(line) + sizeof("Echo: \r\n") - 1;
+}
+
+static void report(int64_t window_ms)
+{
+    uint32_t in = atomic_clear(&lines_in);
+    uint32_t dropped = atomic_clear(&lines_dropped);
+
+    if (in == 0 && dropped == 0) {
+        return;
+    }
 
+    printk("lines %u, dropped %u, wakeups %u (%u.%02u per line), "
+           "echo %u lines/s, %u B/s\n",
+           in, dropped, wakeups,
+           wakeups / MAX(lines_out, 1),
+           wakeups * 100 / MAX(lines_out, 1) % 100,
+           (uint32_t)(lines_out * 1000 / window_ms),
+           (uint32_t)(bytes_out * 1000 / window_ms));
+    rtstats_print(NULL);
+
+    lines_out = 0;
+    bytes_out = 0;
+    wakeups = 0;
+}
+
+/* wait for lines until the end of the report window, false on timeout */
+static bool wait_lines(int64_t window_end)
+{
+    k_timeout_t timeout = K_MSEC(MAX(window_end - k_uptime_get(), 0));
+
+#if defined(CONFIG_APP_UART_MSGQ)
+    /* a line that finds the consumer waiting costs a wakeup */
+    bool waiting = k_msgq_num_used_get(&uart_msgq) == 0;
+
+    if (k_msgq_get(&uart_msgq, &tx_line, timeout) != 0) {
+        return false;
+    }
+    if (waiting) {
+        wakeups++;
+    }
+#else
+    if (k_sem_take(&uart_wake, timeout) != 0) {
+        return false;
+    }
+    if (WAKE_THRESHOLD > 1) {
+        k_timer_stop(&uart_flush);
+    }
+    wakeups++;
+#endif
+    return true;
+}
+
+static void drain_lines(void)
+{
+#if defined(CONFIG_APP_UART_MSGQ)
+    /* one line per k_msgq_get, as before */
+    echo_line(tx_line);
+#else
+    char *line;
+
+    /* echo everything queued, including lines that arrive meanwhile */
+    while ((line = spsc_ring_peek(&uart_lines)) != NULL) {
+        echo_line(line);
+        spsc_ring_release(&uart_lines);
+    }
+#endif
+}
 
 void main(void)
 {
-    char tx_buf[MSG_SIZE];
+    int64_t window_start;
+
+    bootprof_mark(BOOTPROF_MAIN);
 
     if (!device_is_ready(uart_dev)) {
         printk("UART device not found!");
         return;
     }
 
+    rtstats_register_thread(&main_stats, "main", k_current_get());
+#if defined(CONFIG_APP_UART_MSGQ)
+    rtstats_register_msgq(&uart_msgq_stats, "uart_msgq", &uart_msgq);
+#endif
+
     uart_irq_callback_user_data_set(uart_dev, serial_cb, NULL);
     uart_irq_rx_enable(uart_dev);
 
+    bootprof_mark(BOOTPROF_FIRST_UART);
     print_uart("Hello! I'm your echo bot.\r\n");
     print_uart("Tell me something and press enter:\r\n");
+    bootprof_report();
 
-    while (k_msgq_get(&uart_msgq, &tx_buf, K_FOREVER) == 0) {
-        print_uart("Echo: ");
-        print_uart(tx_buf);
-        print_uart("\r\n");
+    window_start = k_uptime_get();
+
+    while (1) {
+        if (wait_lines(window_start + REPORT_MS)) {
+            drain_lines();
+        }
+
+        if (k_uptime_get() - window_start >= REPORT_MS) {
+            report(k_uptime_get() - window_start);
+            window_start = k_uptime_get();
+        }
     }
 }